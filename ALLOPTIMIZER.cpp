@@ -1,33 +1,179 @@
 #pragma once
 
+static const int CHUNK_SHIFT = 4;
+static const int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+static const int CHUNK_MASK = CHUNK_SIZE - 1;
+static const int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+// One 16x16x16 section of the world. Cells hold compact local ids (0 = air,
+// otherwise slot+1 into `blocks`, which maps back to a worldBlocks index).
+struct ChunkSection {
+    int cx, cy, cz;
+    int count;
+    bool dirty;
+    bool edited;    // a block was removed since the section was built
+    uint16_t cells[CHUNK_VOLUME];
+    std::vector<int> blocks;
+    std::vector<uint16_t> freeSlots;
+
+    static int cellIndex(int lx, int ly, int lz) {
+        return (ly << (CHUNK_SHIFT * 2)) | (lz << CHUNK_SHIFT) | lx;
+    }
+
+    int get(int lx, int ly, int lz) const {
+        uint16_t id = cells[cellIndex(lx, ly, lz)];
+        return id ? blocks[id - 1] : -1;
+    }
+
+    void set(int lx, int ly, int lz, int idx) {
+        uint16_t& id = cells[cellIndex(lx, ly, lz)];
+        if (id) { blocks[id - 1] = idx; dirty = true; return; }
+        if (!freeSlots.empty()) {
+            id = freeSlots.back() + 1;
+            freeSlots.pop_back();
+            blocks[id - 1] = idx;
+        } else {
+            blocks.push_back(idx);
+            id = (uint16_t)blocks.size();
+        }
+        count++;
+        dirty = true;
+    }
+
+    void remove(int lx, int ly, int lz) {
+        uint16_t& id = cells[cellIndex(lx, ly, lz)];
+        if (!id) return;
+        freeSlots.push_back(id - 1);
+        blocks[id - 1] = -1;
+        id = 0;
+        count--;
+        dirty = true;
+        edited = true;
+    }
+};
+
+static uint64_t chunkKey(int cx, int cy, int cz) {
+    const uint64_t m = (1u << 21) - 1;
+    return (((uint64_t)(uint32_t)cx & m) << 42) | (((uint64_t)(uint32_t)cy & m) << 21) | ((uint64_t)(uint32_t)cz & m);
+}
+
+static void chunkKeyCoords(uint64_t key, int& cx, int& cy, int& cz) {
+    auto unpack = [](uint64_t v) { int x = (int)(v & ((1u << 21) - 1)); return x >= (1 << 20) ? x - (1 << 21) : x; };
+    cx = unpack(key >> 42);
+    cy = unpack(key >> 21);
+    cz = unpack(key);
+}
+
+// Sparse voxel store: sections are allocated the first time a block lands in
+// them, so memory follows the blocks that exist rather than a bounding box.
 struct BlockGrid {
-    static const int GRID_SIZE = 256;
-    static const int GRID_OFFSET = 64;
-    static const int GRID_HEIGHT = 128;
-    int data[GRID_SIZE][GRID_HEIGHT][GRID_SIZE];
+    std::unordered_map<uint64_t, ChunkSection*> chunks;
 
-    void clear() { memset(data, -1, sizeof(data)); }
+    ~BlockGrid() { clear(); }
+
+    void clear() {
+        for (auto& kv : chunks) delete kv.second;
+        chunks.clear();
+    }
+
+    ChunkSection* findChunk(int cx, int cy, int cz) const {
+        auto it = chunks.find(chunkKey(cx, cy, cz));
+        return it == chunks.end() ? nullptr : it->second;
+    }
+
+    ChunkSection* chunkAt(int cx, int cy, int cz) {
+        ChunkSection*& c = chunks[chunkKey(cx, cy, cz)];
+        if (!c) {
+            c = new ChunkSection();
+            c->cx = cx; c->cy = cy; c->cz = cz;
+            c->count = 0;
+            c->dirty = true;
+            c->edited = false;
+            memset(c->cells, 0, sizeof(c->cells));
+        }
+        return c;
+    }
+
+    void dropChunk(uint64_t key) {
+        auto it = chunks.find(key);
+        if (it == chunks.end()) return;
+        delete it->second;
+        chunks.erase(it);
+    }
+
+    // A cell on a section border affects face culling in the neighbour too.
+    void markBorderDirty(int x, int y, int z) {
+        int cx = x >> CHUNK_SHIFT, cy = y >> CHUNK_SHIFT, cz = z >> CHUNK_SHIFT;
+        int lx = x & CHUNK_MASK, ly = y & CHUNK_MASK, lz = z & CHUNK_MASK;
+        ChunkSection* n;
+        if (lx == 0 && (n = findChunk(cx - 1, cy, cz))) n->dirty = true;
+        if (lx == CHUNK_MASK && (n = findChunk(cx + 1, cy, cz))) n->dirty = true;
+        if (ly == 0 && (n = findChunk(cx, cy - 1, cz))) n->dirty = true;
+        if (ly == CHUNK_MASK && (n = findChunk(cx, cy + 1, cz))) n->dirty = true;
+        if (lz == 0 && (n = findChunk(cx, cy, cz - 1))) n->dirty = true;
+        if (lz == CHUNK_MASK && (n = findChunk(cx, cy, cz + 1))) n->dirty = true;
+    }
 
     void set(int x, int y, int z, int idx) {
-        x += GRID_OFFSET; z += GRID_OFFSET;
-        if (x >= 0 && x < GRID_SIZE && y >= 0 && y < GRID_HEIGHT && z >= 0 && z < GRID_SIZE)
-            data[x][y][z] = idx;
+        if (idx < 0) { remove(x, y, z); return; }
+        chunkAt(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT)
+            ->set(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK, idx);
+        markBorderDirty(x, y, z);
     }
 
-    int get(int x, int y, int z) {
-        x += GRID_OFFSET; z += GRID_OFFSET;
-        if (x >= 0 && x < GRID_SIZE && y >= 0 && y < GRID_HEIGHT && z >= 0 && z < GRID_SIZE)
-            return data[x][y][z];
-        return -1;
+    void remove(int x, int y, int z) {
+        ChunkSection* c = findChunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+        if (!c) return;
+        c->remove(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK);
+        markBorderDirty(x, y, z);
     }
 
-    bool occupied(int x, int y, int z) {
+    int get(int x, int y, int z) const {
+        ChunkSection* c = findChunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+        return c ? c->get(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK) : -1;
+    }
+
+    bool occupied(int x, int y, int z) const {
         return get(x, y, z) >= 0;
     }
+
+    size_t memoryBytes() const {
+        size_t total = 0;
+        for (auto& kv : chunks)
+            total += sizeof(ChunkSection) + kv.second->blocks.capacity() * sizeof(int);
+        return total;
+    }
 };
 
 static BlockGrid* blockGrid = nullptr;
 
+// Remembers the last section looked up, for walks through neighbouring cells
+// that mostly stay inside one chunk.
+struct GridCursor {
+    const BlockGrid& grid;
+    const ChunkSection* chunk = nullptr;
+    int cx = 0, cy = 0, cz = 0;
+    bool valid = false;
+
+    explicit GridCursor(const BlockGrid& g) : grid(g) {}
+
+    int get(int x, int y, int z) {
+        int ncx = x >> CHUNK_SHIFT, ncy = y >> CHUNK_SHIFT, ncz = z >> CHUNK_SHIFT;
+        if (!valid || ncx != cx || ncy != cy || ncz != cz) {
+            chunk = grid.findChunk(ncx, ncy, ncz);
+            cx = ncx; cy = ncy; cz = ncz;
+            valid = true;
+        }
+        return chunk ? chunk->get(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK) : -1;
+    }
+};
+
+static void blockCell(const Block& bl, int& bx, int& by, int& bz) {
+    bx = (int)floorf(bl.position.x + 0.5f);
+    by = (int)floorf(bl.position.y + 0.5f);
+    bz = (int)floorf(bl.position.z + 0.5f);
+}
+
 static void initGrid() {
     if (!blockGrid) blockGrid = new BlockGrid();
 }
@@ -37,9 +183,8 @@ static void rebuildGrid() {
     blockGrid->clear();
     for (int i = 0; i < (int)worldBlocks.size(); i++) {
         if (!worldBlocks[i].active) continue;
-        int bx = (int)floorf(worldBlocks[i].position.x + 0.5f);
-        int by = (int)floorf(worldBlocks[i].position.y + 0.5f);
-        int bz = (int)floorf(worldBlocks[i].position.z + 0.5f);
+        int bx, by, bz;
+        blockCell(worldBlocks[i], bx, by, bz);
         blockGrid->set(bx, by, bz, i);
     }
 }
@@ -64,78 +209,123 @@ static bool faceVisible(Vec3 pos, int face) {
     return true;
 }
 
-static void genCubeOptimized(Vec3 pos, Vec3 col, float size,
+struct CubeFace { int v[4]; Vec3 n; };
+
+static const CubeFace CUBE_FACES[6] = {
+    {{0,3,2,1},{0,0,-1}},{{4,5,6,7},{0,0,1}},
+    {{0,4,7,3},{-1,0,0}},{{1,2,6,5},{1,0,0}},
+    {{0,1,5,4},{0,-1,0}},{{3,7,6,2},{0,1,0}}
+};
+
+// Axis each face's normal runs along (x=0, y=1, z=2), matching CUBE_FACES.
+static const int CUBE_FACE_AXIS[6] = {2, 2, 0, 0, 1, 1};
+
+static float faceShade(Vec3 n) {
+    if (n.y > 0.5f) return 1.0f;
+    if (n.y < -0.5f) return 0.4f;
+    if (fabsf(n.x) > 0.5f) return 0.7f;
+    return 0.8f;
+}
+
+// Emits face f of the box [mn,mx] with the same winding and shading as a cube face.
+static void emitBoxFace(Vec3 mn, Vec3 mx, int f, Vec3 col,
     std::vector<Vertex>& V, std::vector<uint32_t>& I)
 {
-    float h = size * 0.5f;
     Vec3 c[8] = {
-        {pos.x-h,pos.y-h,pos.z-h},{pos.x+h,pos.y-h,pos.z-h},
-        {pos.x+h,pos.y+h,pos.z-h},{pos.x-h,pos.y+h,pos.z-h},
-        {pos.x-h,pos.y-h,pos.z+h},{pos.x+h,pos.y-h,pos.z+h},
-        {pos.x+h,pos.y+h,pos.z+h},{pos.x-h,pos.y+h,pos.z+h}
-    };
-    struct FD { int v[4]; Vec3 n; };
-    FD faces[6] = {
-        {{0,3,2,1},{0,0,-1}},{{4,5,6,7},{0,0,1}},
-        {{0,4,7,3},{-1,0,0}},{{1,2,6,5},{1,0,0}},
-        {{0,1,5,4},{0,-1,0}},{{3,7,6,2},{0,1,0}}
+        {mn.x,mn.y,mn.z},{mx.x,mn.y,mn.z},{mx.x,mx.y,mn.z},{mn.x,mx.y,mn.z},
+        {mn.x,mn.y,mx.z},{mx.x,mn.y,mx.z},{mx.x,mx.y,mx.z},{mn.x,mx.y,mx.z}
     };
+    Vec3 n = CUBE_FACES[f].n;
+    Vec3 fc = col * faceShade(n);
+    uint32_t base = (uint32_t)V.size();
+    for (int v = 0; v < 4; v++) V.push_back({c[CUBE_FACES[f].v[v]], n, fc});
+    I.push_back(base); I.push_back(base+1); I.push_back(base+2);
+    I.push_back(base); I.push_back(base+2); I.push_back(base+3);
+}
+
+static void genCubeOptimized(Vec3 pos, Vec3 col, float size,
+    std::vector<Vertex>& V, std::vector<uint32_t>& I)
+{
+    float h = size * 0.5f;
+    Vec3 mn = {pos.x-h, pos.y-h, pos.z-h};
+    Vec3 mx = {pos.x+h, pos.y+h, pos.z+h};
     for (int f = 0; f < 6; f++) {
         if (!faceVisible(pos, f)) continue;
-        Vec3 n = faces[f].n;
-        float shade;
-        if (n.y > 0.5f) shade = 1.0f;
-        else if (n.y < -0.5f) shade = 0.4f;
-        else if (fabsf(n.x) > 0.5f) shade = 0.7f;
-        else shade = 0.8f;
-        Vec3 fc = col * shade;
-        uint32_t base = (uint32_t)V.size();
-        for (int v = 0; v < 4; v++) V.push_back({c[faces[f].v[v]], n, fc});
-        I.push_back(base); I.push_back(base+1); I.push_back(base+2);
-        I.push_back(base); I.push_back(base+2); I.push_back(base+3);
+        emitBoxFace(mn, mx, f, col, V, I);
     }
 }
 
-static bool collidesPlayerFast(Vec3 pos) {
-    if (!blockGrid) return false;
-    float r = PLAYER_RADIUS;
-    int minX = (int)floorf(pos.x - r - 0.5f);
-    int maxX = (int)floorf(pos.x + r + 1.5f);
-    int minY = (int)floorf(pos.y - 0.5f);
-    int maxY = (int)floorf(pos.y + PLAYER_HEIGHT + 1.5f);
-    int minZ = (int)floorf(pos.z - r - 0.5f);
-    int maxZ = (int)floorf(pos.z + r + 1.5f);
-    for (int bx = minX; bx <= maxX; bx++) {
-        for (int by = minY; by <= maxY; by++) {
-            for (int bz = minZ; bz <= maxZ; bz++) {
-                int idx = blockGrid->get(bx, by, bz);
-                if (idx < 0 || !worldBlocks[idx].active) continue;
-                float h = 0.5f;
-                float blx = worldBlocks[idx].position.x;
-                float bly = worldBlocks[idx].position.y;
-                float blz = worldBlocks[idx].position.z;
-                if (pos.x+r > blx-h && pos.x-r < blx+h &&
-                    pos.y+PLAYER_HEIGHT > bly-h && pos.y < bly+h &&
-                    pos.z+r > blz-h && pos.z-r < blz+h)
-                    return true;
+static bool sameColor(Vec3 a, Vec3 b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+// Greedy mesher: per face direction and slice, visible faces of equal colour
+// are merged into maximal rectangles. Output shading matches genCubeOptimized.
+static void genChunkGreedy(const ChunkSection& c,
+    std::vector<Vertex>& V, std::vector<uint32_t>& I)
+{
+    int origin[3] = {c.cx * CHUNK_SIZE, c.cy * CHUNK_SIZE, c.cz * CHUNK_SIZE};
+    int mask[CHUNK_SIZE * CHUNK_SIZE];
+    for (int f = 0; f < 6; f++) {
+        int d = CUBE_FACE_AXIS[f], u = (d + 1) % 3, v = (d + 2) % 3;
+        int step = (f & 1) ? 1 : -1;
+        for (int s = 0; s < CHUNK_SIZE; s++) {
+            for (int j = 0; j < CHUNK_SIZE; j++) {
+                for (int i = 0; i < CHUNK_SIZE; i++) {
+                    int l[3];
+                    l[d] = s; l[u] = i; l[v] = j;
+                    int idx = c.get(l[0], l[1], l[2]);
+                    if (idx >= 0 && worldBlocks[idx].active) {
+                        l[d] += step;
+                        bool covered;
+                        if (l[d] >= 0 && l[d] < CHUNK_SIZE) covered = c.get(l[0], l[1], l[2]) >= 0;
+                        else covered = gridOccupied(origin[0] + l[0], origin[1] + l[1], origin[2] + l[2]);
+                        if (covered) idx = -1;
+                    } else {
+                        idx = -1;
+                    }
+                    mask[j * CHUNK_SIZE + i] = idx;
+                }
+            }
+            for (int j = 0; j < CHUNK_SIZE; j++) {
+                for (int i = 0; i < CHUNK_SIZE; ) {
+                    int idx = mask[j * CHUNK_SIZE + i];
+                    if (idx < 0) { i++; continue; }
+                    Vec3 col = worldBlocks[idx].color;
+                    int w = 1;
+                    while (i + w < CHUNK_SIZE) {
+                        int o = mask[j * CHUNK_SIZE + i + w];
+                        if (o < 0 || !sameColor(worldBlocks[o].color, col)) break;
+                        w++;
+                    }
+                    int h = 1;
+                    for (; j + h < CHUNK_SIZE; h++) {
+                        bool rowOk = true;
+                        for (int k = 0; k < w; k++) {
+                            int o = mask[(j + h) * CHUNK_SIZE + i + k];
+                            if (o < 0 || !sameColor(worldBlocks[o].color, col)) { rowOk = false; break; }
+                        }
+                        if (!rowOk) break;
+                    }
+                    for (int hh = 0; hh < h; hh++)
+                        for (int k = 0; k < w; k++) mask[(j + hh) * CHUNK_SIZE + i + k] = -1;
+                    float mn[3], mx[3];
+                    mn[d] = origin[d] + s - 0.5f;  mx[d] = mn[d] + 1.0f;
+                    mn[u] = origin[u] + i - 0.5f;  mx[u] = mn[u] + w;
+                    mn[v] = origin[v] + j - 0.5f;  mx[v] = mn[v] + h;
+                    emitBoxFace({mn[0], mn[1], mn[2]}, {mx[0], mx[1], mx[2]}, f, col, V, I);
+                    i += w;
+                }
             }
         }
     }
-    return false;
 }
 
 static void removeBlockFromGrid(int idx) {
     if (!blockGrid || idx < 0) return;
-    Block& bl = worldBlocks[idx];
-    int bx = (int)floorf(bl.position.x + 0.5f);
-    int by = (int)floorf(bl.position.y + 0.5f);
-    int bz = (int)floorf(bl.position.z + 0.5f);
-    bx += BlockGrid::GRID_OFFSET;
-    bz += BlockGrid::GRID_OFFSET;
-    if (bx >= 0 && bx < BlockGrid::GRID_SIZE &&
-        by >= 0 && by < BlockGrid::GRID_HEIGHT &&
-        bz >= 0 && bz < BlockGrid::GRID_SIZE)
-        blockGrid->data[bx][by][bz] = -1;
+    int bx, by, bz;
+    blockCell(worldBlocks[idx], bx, by, bz);
+    if (blockGrid->get(bx, by, bz) == idx) blockGrid->remove(bx, by, bz);
 }
 
 static void cleanupGrid() {
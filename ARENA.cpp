@@ -0,0 +1,148 @@
+#pragma once
+
+// Linear allocator for scratch data that never outlives a frame (or a job).
+// Allocation bumps an offset into one block; nothing is freed individually.
+// A Mark taken on entry and rewound on exit makes it a stack, so nested users
+// share the block without stepping on each other, and reset() at frame end
+// rewinds everything.
+//
+// When the block is full the excess comes from the heap and is counted as a
+// fallback. Once the arena is empty again the block is regrown to the
+// high-water mark, so the next frame of the same shape does no heap
+// allocation at all.
+struct FrameArena {
+    // Heap allocation used when the block is full; freed on rewind or reset.
+    struct Fallback {
+        Fallback* next;
+    };
+
+    struct Mark {
+        size_t used;
+        size_t requested;
+        Fallback* fallbacks;
+    };
+
+    char* block = nullptr;
+    size_t capacity = 0;
+    size_t used = 0;
+    size_t requested = 0;       // bytes handed out since reset, fallbacks included
+    size_t highWater = 0;       // largest `requested` ever seen
+    Fallback* fallbacks = nullptr;
+    uint64_t fallbackAllocs = 0; // since startup
+    uint64_t fallbackFrames = 0; // resets that found at least one fallback
+    uint32_t frameFallbacks = 0; // since the last reset
+
+    explicit FrameArena(size_t initialBytes = 0) {
+        if (initialBytes) grow(initialBytes);
+    }
+    ~FrameArena() {
+        freeFallbacks(nullptr);
+        free(block);
+    }
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t bytes, size_t align) {
+        size_t start = (used + align - 1) & ~(align - 1);
+        requested += bytes + (start - used);
+        highWater = std::max(highWater, requested);
+        if (start + bytes <= capacity) {
+            used = start + bytes;
+            return block + start;
+        }
+        // 16-byte header keeps malloc's alignment for the payload.
+        const size_t header = 16;
+        Fallback* f = (Fallback*)malloc(header + bytes);
+        if (!f) throw std::bad_alloc();
+        f->next = fallbacks;
+        fallbacks = f;
+        fallbackAllocs++;
+        frameFallbacks++;
+        return (char*)f + header;
+    }
+
+    // Only the most recent allocation can be given back; anything else waits
+    // for the next rewind.
+    void deallocate(void* p, size_t bytes) {
+        char* c = (char*)p;
+        if (c >= block && c < block + capacity && c + bytes == block + used) {
+            used -= bytes;
+            requested -= bytes;
+        }
+    }
+
+    Mark mark() const { return {used, requested, fallbacks}; }
+
+    void rewind(const Mark& m) {
+        freeFallbacks(m.fallbacks);
+        used = m.used;
+        requested = m.requested;
+        if (used == 0 && highWater > capacity) grow(highWater);
+    }
+
+    // End of frame: drop everything and start the fallback count over.
+    void reset() {
+        if (frameFallbacks) fallbackFrames++;
+        frameFallbacks = 0;
+        rewind({0, 0, nullptr});
+    }
+
+private:
+    void freeFallbacks(Fallback* keep) {
+        while (fallbacks != keep) {
+            Fallback* next = fallbacks->next;
+            free(fallbacks);
+            fallbacks = next;
+        }
+    }
+
+    void grow(size_t bytes) {
+        bytes = (bytes + 0xFFFF) & ~(size_t)0xFFFF;
+        free(block);
+        block = (char*)malloc(bytes);
+        if (!block) throw std::bad_alloc();
+        capacity = bytes;
+    }
+};
+
+// Rewinds the arena to where it was when the scope began.
+struct ArenaScope {
+    FrameArena& arena;
+    FrameArena::Mark start;
+    explicit ArenaScope(FrameArena& a) : arena(a), start(a.mark()) {}
+    ~ArenaScope() { arena.rewind(start); }
+};
+
+// STL allocator on top of a FrameArena, for containers that must not touch
+// the heap. The container has to be gone before its arena scope ends.
+template <typename T>
+struct ArenaAllocator {
+    using value_type = T;
+    FrameArena* arena;
+
+    explicit ArenaAllocator(FrameArena& a) : arena(&a) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& o) : arena(o.arena) {}
+
+    T* allocate(size_t n) { return (T*)arena->allocate(n * sizeof(T), alignof(T)); }
+    void deallocate(T* p, size_t n) { arena->deallocate(p, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& o) const { return arena == o.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& o) const { return arena != o.arena; }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Scratch for the main thread, reset once per frame by whoever drives the
+// frame (the window loop, the replay bench).
+static FrameArena frameArena(256 * 1024);
+
+// Scratch for jobs. Each thread has its own; users take an ArenaScope so a job
+// leaves it as it found it.
+static FrameArena& threadArena() {
+    static thread_local FrameArena arena(256 * 1024);
+    return arena;
+}
\ No newline at end of file
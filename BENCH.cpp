@@ -0,0 +1,248 @@
+// Headless replay benchmark: builds City 17 from a seed, replays a scripted
+// walk with camera sweeps and block breaks at a fixed tick, and reports how
+// long each phase of the frame took. Same seed and script give the same
+// final state hash on any thread count, so timings are comparable run to run.
+//
+// -size N generates N x N City 17 districts instead of one; -world starts
+// from a saved snapshot instead of generating; -stream streams the unbounded
+// city around the player instead; -save writes the final world, debris
+// included, as a snapshot; -noocclusion culls by the frustum alone.
+// -collision FILE skips the replay and writes the fragment collision table
+// (step time against fragment count) that F6 writes in the game.
+//
+//   BENCH [-ticks N] [-seed S] [-break N] [-threads N] [-size N] [-out FILE] [-world FILE] [-stream] [-save FILE] [-noocclusion]
+//   BENCH -collision FILE [-threads N]
+#include "SIM_CORE.cpp"
+#include "PLATFORM.cpp"
+
+struct BenchPhase {
+    const char* name;
+    int calls = 0;
+    double totalMs = 0, maxMs = 0;
+    std::vector<float> samples;
+};
+
+enum {
+    PHASE_WORLDGEN, PHASE_LOAD, PHASE_MESH_INIT, PHASE_PATTERNS,
+    PHASE_PLAYER, PHASE_PAGING, PHASE_STREAM, PHASE_PUBLISH, PHASE_FRAGMENTS, PHASE_PARTICLES, PHASE_RAYCAST,
+    PHASE_DESTROY, PHASE_REMESH, PHASE_OCCLUDERS, PHASE_VISIBLE, PHASE_INSTANCES,
+    PHASE_COUNT
+};
+
+static BenchPhase benchPhases[PHASE_COUNT];
+static OcclusionBuffer occlusionBuffer;
+
+// Culling summed over the run, in CullStats order.
+static uint64_t cullTotals[9];
+
+static void addCullStats(const CullStats& c) {
+    uint32_t v[9] = {c.chunksTested, c.chunksCulled, c.chunksOccluded, c.fragmentsTested, c.fragmentsCulled,
+        c.fragmentsOccluded, c.particlesTested, c.particlesCulled, c.occluderQuads};
+    for (int i = 0; i < 9; i++) cullTotals[i] += v[i];
+}
+
+struct PhaseScope {
+    BenchPhase& phase;
+    std::chrono::steady_clock::time_point start;
+    explicit PhaseScope(int id) : phase(benchPhases[id]), start(std::chrono::steady_clock::now()) {}
+    ~PhaseScope() {
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        phase.calls++;
+        phase.totalMs += ms;
+        phase.maxMs = std::max(phase.maxMs, ms);
+        phase.samples.push_back((float)ms);
+    }
+};
+
+// One tick of the replay script.
+struct ScriptStep {
+    float yaw, pitch;
+    SimInput input;
+    bool breakTarget;
+};
+
+// Walks a slow figure-eight through the streets while the camera sweeps
+// left and right over the facades; every `breakEvery` ticks it breaks
+// whatever is under the crosshair. Derived only from the seed.
+static std::vector<ScriptStep> makeScript(int ticks, int breakEvery, uint32_t seed) {
+    std::vector<ScriptStep> script(ticks);
+    std::mt19937 g(seed);
+    std::uniform_real_distribution<float> jitter(-0.15f, 0.15f);
+    for (int i = 0; i < ticks; i++) {
+        float t = i / 60.0f;
+        ScriptStep& s = script[i];
+        s.yaw = sinf(t * 0.35f) * 2.2f + jitter(g);
+        s.pitch = -0.15f + sinf(t * 0.9f) * 0.35f;
+        s.input.forward = (i / 240) % 4 == 3 ? 0.0f : 1.0f;
+        s.input.strafe = sinf(t * 0.5f) > 0.6f ? 1.0f : 0.0f;
+        s.input.jump = i % 180 == 90;
+        s.breakTarget = breakEvery > 0 && i % breakEvery == 0;
+    }
+    return script;
+}
+
+static uint64_t hashSimState() {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&](const void* p, size_t n) {
+        const uint8_t* b = (const uint8_t*)p;
+        for (size_t i = 0; i < n; i++) { h ^= b[i]; h *= 1099511628211ull; }
+    };
+    std::vector<const FragmentStore*> stores;
+    collectFragmentStores(stores);
+    for (const FragmentStore* f : stores) {
+        for (size_t i = 0; i < f->size(); i++) {
+            float p[3] = {f->px[i], f->py[i], f->pz[i]};
+            mix(p, sizeof(p));
+        }
+    }
+    mix(&playerPos, sizeof(playerPos));
+    int particlesAlive = particleCount();
+    mix(&particlesAlive, sizeof(particlesAlive));
+    return h;
+}
+
+static void printReport(FILE* out, int ticks, uint32_t seed, int breaks, size_t peakFragments, size_t peakBlocks, uint64_t hash) {
+    fprintf(out, "headless replay: %d ticks at %d Hz, seed %u, %d worker threads\n", ticks, simTickHz, seed, jobWorkerCount());
+    fprintf(out, "blocks %zu, breaks %d, peak fragments %zu, final fragments %zu, particles %d\n",
+        worldBlocks.size(), breaks, peakFragments, fragmentCount(), particleCount());
+    fprintf(out, "%-12s %8s %12s %10s %10s %10s\n", "phase", "calls", "total_ms", "mean_us", "p95_us", "max_us");
+    double frameMs = 0;
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        BenchPhase& p = benchPhases[i];
+        if (!p.calls) continue;
+        std::sort(p.samples.begin(), p.samples.end());
+        double p95 = p.samples[std::min(p.samples.size() - 1, p.samples.size() * 95 / 100)];
+        if (i >= PHASE_PLAYER) frameMs += p.totalMs;
+        fprintf(out, "%-12s %8d %12.3f %10.1f %10.1f %10.1f\n", p.name, p.calls, p.totalMs,
+            p.totalMs * 1000.0 / p.calls, p95 * 1000.0, p.maxMs * 1000.0);
+    }
+    fprintf(out, "per-tick total %.3f ms mean\n", frameMs / std::max(1, ticks));
+    auto pct = [](uint64_t part, uint64_t whole) { return whole ? 100.0 * part / whole : 0.0; };
+    const char* kinds[3] = {"chunks", "fragments", "particles"};
+    for (int k = 0; k < 3; k++) {
+        const uint64_t* t = cullTotals + k * 3;
+        fprintf(out, "%-10s %12llu tested, %5.1f%% outside the frustum", kinds[k], (unsigned long long)t[0], pct(t[1], t[0]));
+        if (k < 2) fprintf(out, ", %5.1f%% occluded", pct(t[2], t[0]));
+        fprintf(out, "\n");
+    }
+    fprintf(out, "occluder quads %.1f per tick\n", (double)cullTotals[8] / std::max(1, ticks));
+    fprintf(out, "frame arena high-water %zu KB, %llu fallback allocs in %llu of %d ticks\n", frameArena.highWater / 1024,
+        (unsigned long long)frameArena.fallbackAllocs, (unsigned long long)frameArena.fallbackFrames, ticks);
+    if (worldStream.active)
+        fprintf(out, "streaming: %zu resident columns, peak block slots %zu, %llu loads, %llu evictions, %llu saves\n",
+            worldStream.residentColumns, peakBlocks, (unsigned long long)worldStream.loads,
+            (unsigned long long)worldStream.evictions, (unsigned long long)worldStream.saves);
+    fprintf(out, "state hash %016llx\n", (unsigned long long)hash);
+}
+
+static const char* argValue(int argc, char** argv, const char* name) {
+    for (int i = 1; i + 1 < argc; i++)
+        if (!strcmp(argv[i], name)) return argv[i + 1];
+    return nullptr;
+}
+
+int main(int argc, char** argv) {
+    const char* a;
+    int ticks = (a = argValue(argc, argv, "-ticks")) ? std::max(1, atoi(a)) : 1800;
+    uint32_t seed = (a = argValue(argc, argv, "-seed")) ? (uint32_t)strtoul(a, nullptr, 10) : 42;
+    int breakEvery = (a = argValue(argc, argv, "-break")) ? atoi(a) : 6;
+    int districts = (a = argValue(argc, argv, "-size")) ? std::max(1, atoi(a)) : 1;
+    const char* outPath = argValue(argc, argv, "-out");
+    initJobs((a = argValue(argc, argv, "-threads")) ? atoi(a) : -1);
+    if ((a = argValue(argc, argv, "-collision"))) {
+        benchFragmentCollision(a);
+        shutdownJobs();
+        return 0;
+    }
+
+    const char* names[PHASE_COUNT] = {
+        "worldgen", "load", "mesh_init", "patterns", "player", "paging", "stream", "publish", "fragments", "particles",
+        "raycast", "destroy", "remesh", "occluders", "visible", "instances"
+    };
+    for (int i = 0; i < PHASE_COUNT; i++) benchPhases[i].name = names[i];
+
+    const char* worldPath = argValue(argc, argv, "-world");
+    const char* savePath = argValue(argc, argv, "-save");
+    bool stream = false, occlusion = true;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-stream")) stream = true;
+        if (!strcmp(argv[i], "-noocclusion")) occlusion = false;
+    }
+    rng.seed(seed);
+    if (stream) {
+        PhaseScope p(PHASE_WORLDGEN);
+        beginStreamingWorld(seed);
+    } else if (worldPath) {
+        PhaseScope p(PHASE_LOAD);
+        if (!loadWorldSnapshot(worldPath)) { fprintf(stderr, "cannot load world snapshot %s\n", worldPath); return 1; }
+    } else {
+        PhaseScope p(PHASE_WORLDGEN);
+        buildCity17Grid(seed, districts);
+    }
+    { PhaseScope p(PHASE_MESH_INIT); updateChunkMeshes(); }
+    { PhaseScope p(PHASE_PATTERNS); initFracturePatterns(); }
+    prevPlayerPos = playerPos;
+
+    std::vector<ScriptStep> script = makeScript(ticks, breakEvery, seed);
+    std::vector<const ChunkMesh*> visible;
+    std::vector<const FragmentStore*> stores;
+    std::vector<InstanceData> instances;
+    std::vector<InstanceBatch> batches;
+    float dt = 1.0f / simTickHz;
+    int breaks = 0;
+    size_t peakFragments = 0;
+    size_t peakBlocks = worldBlocks.size();
+
+    for (const ScriptStep& s : script) {
+        camYaw = s.yaw;
+        camPitch = s.pitch;
+        { PhaseScope p(PHASE_PLAYER); stepPlayer(s.input, dt); }
+        { PhaseScope p(PHASE_PAGING); updateWorldPaging(playerPos); }
+        if (stream) { PhaseScope p(PHASE_STREAM); updateStreaming(playerPos); }
+        { PhaseScope p(PHASE_PUBLISH); publishFractureJobs(); }
+        { PhaseScope p(PHASE_FRAGMENTS); updateAllFragments(dt); }
+        { PhaseScope p(PHASE_PARTICLES); updateParticles(dt); }
+        { PhaseScope p(PHASE_RAYCAST); findTarget(); }
+        if (s.breakTarget && hasTarget) {
+            PhaseScope p(PHASE_DESTROY);
+            destroyBlock(targetBlockIdx);
+            breaks++;
+        }
+        { PhaseScope p(PHASE_REMESH); updateChunkMeshes(); }
+        cullStats = CullStats();
+        Mat4 viewProj = cameraViewProj(getEyePos(), 16.0f / 9.0f);
+        Frustum frustum = Frustum::fromMatrix(viewProj);
+        const OcclusionBuffer* occ = occlusion ? &occlusionBuffer : nullptr;
+        if (occlusion) {
+            PhaseScope p(PHASE_OCCLUDERS);
+            occlusionBuffer.begin(viewProj);
+            drawChunkOccluders(occlusionBuffer, getEyePos(), frustum);
+        }
+        { PhaseScope p(PHASE_VISIBLE); collectVisibleChunks(getEyePos(), 80.0f, visible, &frustum, occ); }
+        {
+            PhaseScope p(PHASE_INSTANCES);
+            collectFragmentStores(stores);
+            buildFragmentInstances(stores, instances, batches, 1.0f, &frustum, occ);
+            buildParticleInstances(instances, batches, 1.0f, &frustum);
+        }
+        addCullStats(cullStats);
+        recycleReleasedMeshes();
+        frameArena.reset();
+        peakFragments = std::max(peakFragments, fragmentCount());
+        peakBlocks = std::max(peakBlocks, worldBlocks.size());
+    }
+
+    flushFractureJobs();
+    flushStreaming();
+    uint64_t hash = hashSimState();
+    printReport(stdout, ticks, seed, breaks, peakFragments, peakBlocks, hash);
+    if (savePath && !saveWorldSnapshot(savePath)) fprintf(stderr, "cannot write world snapshot %s\n", savePath);
+    if (outPath) {
+        FILE* f = fopen(outPath, "w");
+        if (f) { printReport(f, ticks, seed, breaks, peakFragments, peakBlocks, hash); fclose(f); }
+    }
+    clearFragments();
+    clearParticles();
+    shutdownJobs();
+    return 0;
+}
\ No newline at end of file
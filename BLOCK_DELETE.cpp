@@ -1 +1,13 @@
-#pragma once
\ No newline at end of file
+#pragma once
+
+// Breaks a world block: it leaves the grid at once, and any debris sleeping on
+// or against it is woken so it can fall. The fragments are built on a worker
+// and appear a couple of ticks later (see publishFractureJobs).
+static void destroyBlock(int idx) {
+    Block& bl = worldBlocks[idx];
+    if (!bl.active) return;
+    bl.active = false;
+    submitFracture(bl);
+    removeBlockFromGrid(idx);
+    wakeFragmentsNear(bl.position, PHYS_WAKE_RADIUS);
+}
\ No newline at end of file
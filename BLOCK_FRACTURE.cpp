@@ -2,61 +2,36 @@
 
 static const int FRACTURE_MIN_PIECES = 7;
 static const int FRACTURE_MAX_PIECES = 14;
-static const int MICRO_PARTICLES = 25;
-static const int DUST_PARTICLES = 40;
-static const float MICRO_SIZE = 0.035f;
-static const float DUST_SIZE = 0.015f;
 static const int SECONDARY_FRACTURE_CHANCE = 3;
 static const int CRACK_DEPTH_LEVELS = 3;
 
-static Vec3 randomPointInCube(Vec3 center, float halfSize) {
-    std::uniform_real_distribution<float> d(-halfSize, halfSize);
-    return {center.x + d(rng), center.y + d(rng), center.z + d(rng)};
-}
-
-static bool pointBehindPlane(Vec3 point, Vec3 planePoint, Vec3 planeNormal) {
-    return Vec3::dot(point - planePoint, planeNormal) < 0;
-}
+// Capacity of the clipping buffers. A cube cut by at most 13 bisectors and
+// one secondary plane has at most 20 faces, and each face gains at most one
+// vertex per cut, so 24 of each never overflows.
+static const int MAX_FACE_VERTS = 24;
+static const int MAX_SHAPE_FACES = 24;
 
-static Vec3 linePlaneIntersect(Vec3 a, Vec3 b, Vec3 planePoint, Vec3 planeNormal) {
-    Vec3 ab = b - a;
-    float denom = Vec3::dot(ab, planeNormal);
-    if (fabsf(denom) < 1e-8f) return a;
-    float t = Vec3::dot(planePoint - a, planeNormal) / denom;
-    if (t < 0) t = 0;
-    if (t > 1) t = 1;
-    return a + ab * t;
+static Vec3 randomPointInCube(std::mt19937& g, Vec3 center, float halfSize) {
+    std::uniform_real_distribution<float> d(-halfSize, halfSize);
+    return {center.x + d(g), center.y + d(g), center.z + d(g)};
 }
 
-static std::vector<Vec3> clipPolygonByPlane(
-    const std::vector<Vec3>& poly, Vec3 planePoint, Vec3 planeNormal)
-{
-    if (poly.size() < 3) return {};
-    std::vector<Vec3> result;
-    int n = (int)poly.size();
-    for (int i = 0; i < n; i++) {
-        Vec3 curr = poly[i];
-        Vec3 next = poly[(i + 1) % n];
-        bool currInside = !pointBehindPlane(curr, planePoint, planeNormal);
-        bool nextInside = !pointBehindPlane(next, planePoint, planeNormal);
-        if (currInside) {
-            result.push_back(curr);
-            if (!nextInside)
-                result.push_back(linePlaneIntersect(curr, next, planePoint, planeNormal));
-        } else if (nextInside) {
-            result.push_back(linePlaneIntersect(curr, next, planePoint, planeNormal));
-        }
-    }
-    return result;
-}
+struct ShapeFace {
+    Vec3 v[MAX_FACE_VERTS];
+    int n;
+    bool cut;
+};
 
+// Convex polyhedron as a fixed-size list of outward-wound faces. Lives on the
+// stack; clipping writes into a second shape instead of allocating.
 struct ConvexShape {
-    std::vector<std::vector<Vec3>> faces;
-    std::vector<bool> isCutFace;
+    ShapeFace faces[MAX_SHAPE_FACES];
+    int faceCount = 0;
+
+    bool empty() const { return faceCount == 0; }
 };
 
-static ConvexShape makeCubeShape(Vec3 center, float halfSize) {
-    ConvexShape shape;
+static void makeCubeShape(Vec3 center, float halfSize, ConvexShape& shape) {
     float h = halfSize;
     Vec3 c = center;
     Vec3 corners[8] = {
@@ -65,71 +40,109 @@ static ConvexShape makeCubeShape(Vec3 center, float halfSize) {
         {c.x-h,c.y-h,c.z+h},{c.x+h,c.y-h,c.z+h},
         {c.x+h,c.y+h,c.z+h},{c.x-h,c.y+h,c.z+h}
     };
-    shape.faces.push_back({corners[0],corners[3],corners[2],corners[1]});
-    shape.faces.push_back({corners[4],corners[5],corners[6],corners[7]});
-    shape.faces.push_back({corners[0],corners[4],corners[7],corners[3]});
-    shape.faces.push_back({corners[1],corners[2],corners[6],corners[5]});
-    shape.faces.push_back({corners[0],corners[1],corners[5],corners[4]});
-    shape.faces.push_back({corners[3],corners[7],corners[6],corners[2]});
-    for (int i = 0; i < 6; i++) shape.isCutFace.push_back(false);
-    return shape;
+    static const int quads[6][4] = {
+        {0,3,2,1},{4,5,6,7},{0,4,7,3},{1,2,6,5},{0,1,5,4},{3,7,6,2}
+    };
+    shape.faceCount = 6;
+    for (int f = 0; f < 6; f++) {
+        ShapeFace& face = shape.faces[f];
+        for (int k = 0; k < 4; k++) face.v[k] = corners[quads[f][k]];
+        face.n = 4;
+        face.cut = false;
+    }
 }
 
-static ConvexShape clipShapeByPlane(const ConvexShape& shape, Vec3 planePoint, Vec3 planeNormal) {
-    ConvexShape result;
-    std::vector<Vec3> capPoints;
-
-    for (int fi = 0; fi < (int)shape.faces.size(); fi++) {
-        std::vector<Vec3> clipped = clipPolygonByPlane(shape.faces[fi], planePoint, planeNormal);
-        if (clipped.size() >= 3) {
-            result.faces.push_back(clipped);
-            result.isCutFace.push_back(shape.isCutFace[fi]);
-            for (auto& p : clipped) {
-                float dist = fabsf(Vec3::dot(p - planePoint, planeNormal));
-                if (dist < 0.01f) capPoints.push_back(p);
-            }
-        }
-    }
+// Point where the edge between an inside and an outside vertex crosses the
+// plane. Always interpolated from the inside end, so the two faces sharing an
+// edge produce bit-identical points and the cap can be stitched exactly.
+static Vec3 planeCrossing(Vec3 in, float dIn, Vec3 out, float dOut) {
+    float t = dIn / (dIn - dOut);
+    return in + (out - in) * t;
+}
 
-    if (capPoints.size() >= 3) {
-        std::vector<Vec3> uniqueCap;
-        for (auto& p : capPoints) {
-            bool dup = false;
-            for (auto& u : uniqueCap) {
-                if ((p - u).lengthSq() < 0.0001f) { dup = true; break; }
-            }
-            if (!dup) uniqueCap.push_back(p);
+// Keeps the part of `shape` on the side `planeNormal` points to and closes it
+// with a cap face on the plane. Returns false when nothing is left.
+static bool clipShapeByPlane(const ConvexShape& shape, Vec3 planePoint, Vec3 planeNormal, ConvexShape& out) {
+    // Each cut face leaves one edge on the plane: exit[k] -> entry[k] in the
+    // face's winding. The cap runs those edges backwards, and one face's exit
+    // point is its neighbour's entry point, which is how they are chained.
+    Vec3 exitPt[MAX_SHAPE_FACES], entryPt[MAX_SHAPE_FACES];
+    int capEdges = 0;
+    out.faceCount = 0;
+
+    for (int fi = 0; fi < shape.faceCount; fi++) {
+        const ShapeFace& face = shape.faces[fi];
+        float d[MAX_FACE_VERTS];
+        bool anyIn = false, anyOut = false;
+        for (int i = 0; i < face.n; i++) {
+            d[i] = Vec3::dot(face.v[i] - planePoint, planeNormal);
+            if (d[i] >= 0) anyIn = true; else anyOut = true;
         }
-        if (uniqueCap.size() >= 3) {
-            Vec3 cc = {0, 0, 0};
-            for (auto& p : uniqueCap) cc += p;
-            cc = cc * (1.0f / uniqueCap.size());
-            Vec3 refDir = (uniqueCap[0] - cc).normalized();
-            Vec3 rightDir = Vec3::cross(planeNormal, refDir).normalized();
-            if (rightDir.lengthSq() < 0.001f) {
-                Vec3 alt = fabsf(planeNormal.y) > 0.9f ? Vec3{1,0,0} : Vec3{0,1,0};
-                rightDir = Vec3::cross(planeNormal, alt).normalized();
-                refDir = Vec3::cross(rightDir, planeNormal).normalized();
+        if (!anyIn) continue;
+        if (out.faceCount == MAX_SHAPE_FACES) break;
+        ShapeFace& dst = out.faces[out.faceCount];
+        dst.cut = face.cut;
+        if (!anyOut) {
+            dst = face;
+            out.faceCount++;
+            continue;
+        }
+        int n = 0;
+        bool hasExit = false, hasEntry = false;
+        Vec3 ex = {0, 0, 0}, en = {0, 0, 0};
+        for (int i = 0; i < face.n && n < MAX_FACE_VERTS - 1; i++) {
+            int j = i + 1 == face.n ? 0 : i + 1;
+            bool inI = d[i] >= 0, inJ = d[j] >= 0;
+            if (inI) {
+                dst.v[n++] = face.v[i];
+                if (!inJ) { ex = planeCrossing(face.v[i], d[i], face.v[j], d[j]); dst.v[n++] = ex; hasExit = true; }
+            } else if (inJ) {
+                en = planeCrossing(face.v[j], d[j], face.v[i], d[i]);
+                dst.v[n++] = en;
+                hasEntry = true;
             }
-            std::sort(uniqueCap.begin(), uniqueCap.end(),
-                [&](const Vec3& a, const Vec3& b) {
-                    Vec3 da = a - cc;
-                    Vec3 db = b - cc;
-                    return atan2f(Vec3::dot(da, rightDir), Vec3::dot(da, refDir))
-                         < atan2f(Vec3::dot(db, rightDir), Vec3::dot(db, refDir));
-                });
-            result.faces.push_back(uniqueCap);
-            result.isCutFace.push_back(true);
         }
+        dst.n = n;
+        if (hasExit && hasEntry) {
+            exitPt[capEdges] = ex;
+            entryPt[capEdges] = en;
+            capEdges++;
+        }
+        if (n >= 3) out.faceCount++;
     }
-    return result;
+    if (out.faceCount == 0 || capEdges < 3 || out.faceCount == MAX_SHAPE_FACES) return out.faceCount > 0;
+
+    ShapeFace& cap = out.faces[out.faceCount];
+    cap.cut = true;
+    cap.n = 0;
+    bool used[MAX_SHAPE_FACES] = {};
+    int k = 0;
+    for (int step = 0; step < capEdges; step++) {
+        used[k] = true;
+        cap.v[cap.n++] = exitPt[k];
+        int next = -1;
+        float best = 1e-8f;
+        for (int m = 0; m < capEdges; m++) {
+            if (used[m]) continue;
+            float dist = (entryPt[m] - exitPt[k]).lengthSq();
+            if (dist <= best) { best = dist; next = m; if (dist == 0) break; }
+        }
+        if (next < 0) break;
+        k = next;
+    }
+    if (cap.n < 3) return true;
+    // Outward for the cap is against the plane normal.
+    Vec3 nrm = Vec3::cross(cap.v[1] - cap.v[0], cap.v[2] - cap.v[0]);
+    if (Vec3::dot(nrm, planeNormal) > 0) std::reverse(cap.v, cap.v + cap.n);
+    out.faceCount++;
+    return true;
 }
 
 static Vec3 shapeCenter(const ConvexShape& shape) {
     Vec3 sum = {0, 0, 0};
     int count = 0;
-    for (auto& face : shape.faces) {
-        for (auto& p : face) { sum += p; count++; }
+    for (int f = 0; f < shape.faceCount; f++) {
+        for (int i = 0; i < shape.faces[f].n; i++) { sum += shape.faces[f].v[i]; count++; }
     }
     return count > 0 ? sum * (1.0f / count) : sum;
 }
@@ -137,47 +150,50 @@ static Vec3 shapeCenter(const ConvexShape& shape) {
 static float shapeVolume(const ConvexShape& shape) {
     Vec3 c = shapeCenter(shape);
     float vol = 0;
-    for (auto& face : shape.faces) {
-        if (face.size() < 3) continue;
-        for (int i = 1; i < (int)face.size() - 1; i++) {
-            Vec3 a = face[0] - c;
-            Vec3 b = face[i] - c;
-            Vec3 d = face[i + 1] - c;
+    for (int f = 0; f < shape.faceCount; f++) {
+        const ShapeFace& face = shape.faces[f];
+        for (int i = 1; i < face.n - 1; i++) {
+            Vec3 a = face.v[0] - c;
+            Vec3 b = face.v[i] - c;
+            Vec3 d = face.v[i + 1] - c;
             vol += fabsf(Vec3::dot(a, Vec3::cross(b, d))) / 6.0f;
         }
     }
     return vol;
 }
 
-static Vec3 perturbPoint(Vec3 p, float amount) {
+static Vec3 perturbPoint(std::mt19937& g, Vec3 p, float amount) {
     std::uniform_real_distribution<float> d(-amount, amount);
-    return {p.x + d(rng), p.y + d(rng), p.z + d(rng)};
+    return {p.x + d(g), p.y + d(g), p.z + d(g)};
 }
 
-static void addMicroCracksToFace(const std::vector<Vec3>& face, Vec3 center,
+static Vec3 faceCentroid(const ShapeFace& face) {
+    Vec3 c = {0, 0, 0};
+    for (int i = 0; i < face.n; i++) c += face.v[i];
+    return c * (1.0f / face.n);
+}
+
+static void addMicroCracksToFace(std::mt19937& g, const ShapeFace& face, Vec3 center,
     Vec3 faceNormal, Vec3 color, int depth,
-    std::vector<Vertex>& V, std::vector<uint32_t>& I)
+    ArenaVector<Vertex>& V, ArenaVector<uint32_t>& I)
 {
-    if (face.size() < 3 || depth <= 0) return;
+    if (face.n < 3 || depth <= 0) return;
 
     Vec3 darkColor = {color.x * 0.15f, color.y * 0.15f, color.z * 0.15f};
     std::uniform_real_distribution<float> cv(-0.03f, 0.03f);
 
-    Vec3 faceCenter = {0, 0, 0};
-    for (auto& p : face) faceCenter += p;
-    faceCenter = faceCenter * (1.0f / face.size());
-    faceCenter = faceCenter - center;
+    Vec3 faceCenter = faceCentroid(face) - center;
 
     float lineWidth = 0.006f / (float)depth;
     Vec3 offset = faceNormal * (0.001f * depth);
 
     std::uniform_int_distribution<int> crackCount(2, 4);
-    int numCracks = crackCount(rng);
+    int numCracks = crackCount(g);
 
     for (int c = 0; c < numCracks; c++) {
-        std::uniform_int_distribution<int> startIdx(0, (int)face.size() - 1);
-        int si = startIdx(rng);
-        Vec3 start = face[si] - center;
+        std::uniform_int_distribution<int> startIdx(0, face.n - 1);
+        int si = startIdx(g);
+        Vec3 start = face.v[si] - center;
         Vec3 end = faceCenter;
 
         std::uniform_real_distribution<float> bend(-0.08f, 0.08f);
@@ -187,9 +203,9 @@ static void addMicroCracksToFace(const std::vector<Vec3>& face, Vec3 center,
         for (int s = 1; s <= segments; s++) {
             float t = (float)s / (float)segments;
             Vec3 curr = {
-                start.x + (end.x - start.x) * t + bend(rng),
-                start.y + (end.y - start.y) * t + bend(rng),
-                start.z + (end.z - start.z) * t + bend(rng)
+                start.x + (end.x - start.x) * t + bend(g),
+                start.y + (end.y - start.y) * t + bend(g),
+                start.z + (end.z - start.z) * t + bend(g)
             };
 
             Vec3 segDir = (curr - prev).normalized();
@@ -197,9 +213,9 @@ static void addMicroCracksToFace(const std::vector<Vec3>& face, Vec3 center,
             if (segNormal.lengthSq() < 0.001f) continue;
 
             Vec3 crackCol = {
-                clampf(darkColor.x + cv(rng), 0, 1),
-                clampf(darkColor.y + cv(rng), 0, 1),
-                clampf(darkColor.z + cv(rng), 0, 1)
+                clampf(darkColor.x + cv(g), 0, 1),
+                clampf(darkColor.y + cv(g), 0, 1),
+                clampf(darkColor.z + cv(g), 0, 1)
             };
 
             uint32_t base = (uint32_t)V.size();
@@ -212,9 +228,9 @@ static void addMicroCracksToFace(const std::vector<Vec3>& face, Vec3 center,
 
             if (depth > 1 && s == segments / 2) {
                 std::uniform_int_distribution<int> branch(0, 2);
-                if (branch(rng) == 0) {
+                if (branch(g) == 0) {
                     Vec3 branchEnd = curr + segNormal * 0.1f;
-                    branchEnd = perturbPoint(branchEnd, 0.03f);
+                    branchEnd = perturbPoint(g, branchEnd, 0.03f);
                     float bw = lineWidth * 0.6f;
                     Vec3 bDir = (branchEnd - curr).normalized();
                     Vec3 bNorm = Vec3::cross(bDir, faceNormal).normalized();
@@ -234,40 +250,38 @@ static void addMicroCracksToFace(const std::vector<Vec3>& face, Vec3 center,
     }
 }
 
-static void addCutSurfaceDetail(const std::vector<Vec3>& face, Vec3 center,
+static void addCutSurfaceDetail(std::mt19937& g, const ShapeFace& face, Vec3 center,
     Vec3 faceNormal, Vec3 color,
-    std::vector<Vertex>& V, std::vector<uint32_t>& I)
+    ArenaVector<Vertex>& V, ArenaVector<uint32_t>& I)
 {
-    if (face.size() < 3) return;
+    if (face.n < 3) return;
 
-    Vec3 faceCenter = {0, 0, 0};
-    for (auto& p : face) faceCenter += p;
-    faceCenter = faceCenter * (1.0f / face.size());
+    Vec3 faceCenter = faceCentroid(face);
 
     std::uniform_real_distribution<float> cv(-0.04f, 0.04f);
     std::uniform_real_distribution<float> bumpAmt(-0.01f, 0.01f);
     Vec3 offset = faceNormal * 0.001f;
 
-    int n = (int)face.size();
+    int n = face.n;
     for (int i = 0; i < n; i++) {
-        Vec3 a = face[i] - center;
-        Vec3 b = face[(i + 1) % n] - center;
+        Vec3 a = face.v[i] - center;
+        Vec3 b = face.v[(i + 1) % n] - center;
         Vec3 mid = (a + b) * 0.5f;
-        mid = mid + faceNormal * bumpAmt(rng);
+        mid = mid + faceNormal * bumpAmt(g);
 
         Vec3 fc2 = faceCenter - center;
         Vec3 innerA = a + (fc2 - a) * 0.15f;
         Vec3 innerB = b + (fc2 - b) * 0.15f;
 
         Vec3 roughCol = {
-            clampf(color.x * 0.45f + cv(rng), 0, 1),
-            clampf(color.y * 0.45f + cv(rng), 0, 1),
-            clampf(color.z * 0.45f + cv(rng), 0, 1)
+            clampf(color.x * 0.45f + cv(g), 0, 1),
+            clampf(color.y * 0.45f + cv(g), 0, 1),
+            clampf(color.z * 0.45f + cv(g), 0, 1)
         };
         Vec3 roughCol2 = {
-            clampf(color.x * 0.55f + cv(rng), 0, 1),
-            clampf(color.y * 0.55f + cv(rng), 0, 1),
-            clampf(color.z * 0.55f + cv(rng), 0, 1)
+            clampf(color.x * 0.55f + cv(g), 0, 1),
+            clampf(color.y * 0.55f + cv(g), 0, 1),
+            clampf(color.z * 0.55f + cv(g), 0, 1)
         };
 
         uint32_t base = (uint32_t)V.size();
@@ -284,16 +298,15 @@ static void addCutSurfaceDetail(const std::vector<Vec3>& face, Vec3 center,
     }
 }
 
-static void shapeToMesh(const ConvexShape& shape, Vec3 center, Vec3 color,
-    std::vector<Vertex>& V, std::vector<uint32_t>& I)
+static void shapeToMesh(std::mt19937& g, const ConvexShape& shape, Vec3 center, Vec3 color,
+    ArenaVector<Vertex>& V, ArenaVector<uint32_t>& I)
 {
-    for (int fi = 0; fi < (int)shape.faces.size(); fi++) {
-        auto& face = shape.faces[fi];
-        if (face.size() < 3) continue;
-        bool isCut = fi < (int)shape.isCutFace.size() && shape.isCutFace[fi];
+    for (int fi = 0; fi < shape.faceCount; fi++) {
+        const ShapeFace& face = shape.faces[fi];
+        if (face.n < 3) continue;
 
-        Vec3 e1 = face[1] - face[0];
-        Vec3 e2 = face[2] - face[0];
+        Vec3 e1 = face.v[1] - face.v[0];
+        Vec3 e2 = face.v[2] - face.v[0];
         Vec3 normal = Vec3::cross(e1, e2).normalized();
 
         float shade;
@@ -303,61 +316,60 @@ static void shapeToMesh(const ConvexShape& shape, Vec3 center, Vec3 color,
         else shade = 0.8f;
 
         Vec3 fc;
-        if (isCut) {
+        if (face.cut) {
             std::uniform_real_distribution<float> cv(-0.03f, 0.03f);
             fc = {
-                clampf(color.x * shade * 0.55f + cv(rng), 0, 1),
-                clampf(color.y * shade * 0.55f + cv(rng), 0, 1),
-                clampf(color.z * shade * 0.55f + cv(rng), 0, 1)
+                clampf(color.x * shade * 0.55f + cv(g), 0, 1),
+                clampf(color.y * shade * 0.55f + cv(g), 0, 1),
+                clampf(color.z * shade * 0.55f + cv(g), 0, 1)
             };
         } else {
             std::uniform_real_distribution<float> cv(-0.015f, 0.015f);
             fc = {
-                clampf(color.x * shade + cv(rng), 0, 1),
-                clampf(color.y * shade + cv(rng), 0, 1),
-                clampf(color.z * shade + cv(rng), 0, 1)
+                clampf(color.x * shade + cv(g), 0, 1),
+                clampf(color.y * shade + cv(g), 0, 1),
+                clampf(color.z * shade + cv(g), 0, 1)
             };
         }
 
         uint32_t base = (uint32_t)V.size();
-        for (auto& p : face) V.push_back({p - center, normal, fc});
-        for (int i = 1; i < (int)face.size() - 1; i++) {
+        for (int i = 0; i < face.n; i++) V.push_back({face.v[i] - center, normal, fc});
+        for (int i = 1; i < face.n - 1; i++) {
             I.push_back(base);
             I.push_back(base + i);
             I.push_back(base + i + 1);
         }
 
-        if (isCut) {
-            addCutSurfaceDetail(face, center, normal, color, V, I);
+        if (face.cut) {
+            addCutSurfaceDetail(g, face, center, normal, color, V, I);
             for (int d = 1; d <= CRACK_DEPTH_LEVELS; d++) {
-                addMicroCracksToFace(face, center, normal, color, d, V, I);
+                addMicroCracksToFace(g, face, center, normal, color, d, V, I);
             }
         } else {
             std::uniform_int_distribution<int> surfCrack(0, 3);
-            if (surfCrack(rng) == 0) {
-                addMicroCracksToFace(face, center, normal, color, 1, V, I);
+            if (surfCrack(g) == 0) {
+                addMicroCracksToFace(g, face, center, normal, color, 1, V, I);
             }
         }
     }
 }
 
 static void addEdgeCracks(const ConvexShape& shape, Vec3 center, Vec3 color,
-    std::vector<Vertex>& V, std::vector<uint32_t>& I)
+    ArenaVector<Vertex>& V, ArenaVector<uint32_t>& I)
 {
     Vec3 darkColor = {color.x * 0.12f, color.y * 0.12f, color.z * 0.12f};
     float lineThick = 0.005f;
 
-    for (int fi = 0; fi < (int)shape.faces.size(); fi++) {
-        if (fi >= (int)shape.isCutFace.size() || !shape.isCutFace[fi]) continue;
-        auto& face = shape.faces[fi];
-        if (face.size() < 3) continue;
+    for (int fi = 0; fi < shape.faceCount; fi++) {
+        const ShapeFace& face = shape.faces[fi];
+        if (!face.cut || face.n < 3) continue;
 
-        Vec3 faceNormal = Vec3::cross(face[1] - face[0], face[2] - face[0]).normalized();
+        Vec3 faceNormal = Vec3::cross(face.v[1] - face.v[0], face.v[2] - face.v[0]).normalized();
         Vec3 offset = faceNormal * 0.002f;
 
-        for (int i = 0; i < (int)face.size(); i++) {
-            Vec3 a = face[i] - center;
-            Vec3 b = face[(i + 1) % face.size()] - center;
+        for (int i = 0; i < face.n; i++) {
+            Vec3 a = face.v[i] - center;
+            Vec3 b = face.v[(i + 1) % face.n] - center;
             Vec3 edgeDir = (b - a).normalized();
             Vec3 edgeNormal = Vec3::cross(edgeDir, faceNormal).normalized();
             if (edgeNormal.lengthSq() < 0.001f) continue;
@@ -373,225 +385,305 @@ static void addEdgeCracks(const ConvexShape& shape, Vec3 center, Vec3 color,
     }
 }
 
-static void spawnDustCloud(Vec3 blockPos, Vec3 color) {
-    std::uniform_real_distribution<float> pd(-0.45f, 0.45f);
-    std::uniform_real_distribution<float> vd(-1.0f, 1.0f);
-    std::uniform_real_distribution<float> vy(0.0f, 0.8f);
-    std::uniform_real_distribution<float> sd(0.6f, 1.4f);
-    std::uniform_real_distribution<float> cv(-0.04f, 0.04f);
+// Vertices and indices of a piece, not yet in the mesh library.
+struct PieceGeometry {
+    std::vector<Vertex> verts;
+    std::vector<uint32_t> inds;
+};
 
-    for (int i = 0; i < DUST_PARTICLES; i++) {
-        Fragment fr;
-        fr.position = {
-            blockPos.x + pd(rng),
-            blockPos.y + pd(rng),
-            blockPos.z + pd(rng)
-        };
-        fr.velocity = {vd(rng), vy(rng), vd(rng)};
-        fr.rotation = {0, 0, 0};
-        fr.rotSpeed = {vd(rng) * 0.2f, vd(rng) * 0.2f, vd(rng) * 0.2f};
-        fr.color = color;
-
-        float s = DUST_SIZE * sd(rng);
-        float hs = s * 0.5f;
-
-        Vec3 dustCol = {
-            clampf(color.x * 0.8f + cv(rng), 0, 1),
-            clampf(color.y * 0.8f + cv(rng), 0, 1),
-            clampf(color.z * 0.8f + cv(rng), 0, 1)
-        };
+// Meshes the piece in this thread's arena, then copies it out at its final
+// size, so the growing vectors never touch the heap.
+static void shapeGeometry(std::mt19937& g, const ConvexShape& shape, Vec3 center, Vec3 color, PieceGeometry& out) {
+    FrameArena& arena = threadArena();
+    ArenaScope scratch(arena);
+    ArenaVector<Vertex> V{ArenaAllocator<Vertex>(arena)};
+    ArenaVector<uint32_t> I{ArenaAllocator<uint32_t>(arena)};
+    // Largest pieces come to about 3300 vertices and 4700 indices.
+    V.reserve(4096);
+    I.reserve(6144);
+    shapeToMesh(g, shape, center, color, V, I);
+    addEdgeCracks(shape, center, color, V, I);
+    out.verts.assign(V.begin(), V.end());
+    out.inds.assign(I.begin(), I.end());
+}
 
-        Vec3 cc[8] = {
-            {-hs,-hs,-hs},{hs,-hs,-hs},{hs,hs,-hs},{-hs,hs,-hs},
-            {-hs,-hs,hs},{hs,-hs,hs},{hs,hs,hs},{-hs,hs,hs}
-        };
-        struct FD { int v[4]; Vec3 n; };
-        FD ff[6] = {
-            {{0,3,2,1},{0,0,-1}},{{4,5,6,7},{0,0,1}},
-            {{0,4,7,3},{-1,0,0}},{{1,2,6,5},{1,0,0}},
-            {{0,1,5,4},{0,-1,0}},{{3,7,6,2},{0,1,0}}
-        };
-        for (int f = 0; f < 6; f++) {
-            uint32_t base = (uint32_t)fr.vertices.size();
-            for (int v = 0; v < 4; v++)
-                fr.vertices.push_back({cc[ff[f].v[v]], ff[f].n, dustCol});
-            fr.indices.push_back(base); fr.indices.push_back(base+1); fr.indices.push_back(base+2);
-            fr.indices.push_back(base); fr.indices.push_back(base+2); fr.indices.push_back(base+3);
-        }
+static int shapeMesh(std::mt19937& g, const ConvexShape& shape, Vec3 center, Vec3 color) {
+    PieceGeometry geo;
+    shapeGeometry(g, shape, center, color, geo);
+    return createMesh(std::move(geo.verts), std::move(geo.inds));
+}
 
-        fr.scale = {1, 1, 1};
-        fr.lifetime = 0;
-        fr.maxLifetime = 5.0f;
-        fr.eternal = fragmentsEternal;
-        fr.active = true;
-        fragments.push_back(fr);
+// Voronoi cell of seeds[i] inside the cube, built by clipping against the
+// bisector of every other seed. `jitter` shifts each bisector slightly.
+static bool voronoiCell(std::mt19937& g, const Vec3* seeds, int count, int i,
+    Vec3 center, float halfSize, float jitter, ConvexShape& cell)
+{
+    ConvexShape tmp;
+    ConvexShape* cur = &cell;
+    ConvexShape* nxt = &tmp;
+    makeCubeShape(center, halfSize, *cur);
+    std::uniform_real_distribution<float> jd(-jitter, jitter);
+    for (int j = 0; j < count; j++) {
+        if (i == j) continue;
+        Vec3 mid = (seeds[i] + seeds[j]) * 0.5f;
+        Vec3 dir = (seeds[i] - seeds[j]).normalized();
+        if (jitter > 0) { mid.x += jd(g); mid.y += jd(g); mid.z += jd(g); }
+        if (!clipShapeByPlane(*cur, mid, dir, *nxt)) return false;
+        std::swap(cur, nxt);
     }
+    if (cur != &cell) cell = *cur;
+    return true;
 }
 
-static void spawnMicroParticles(Vec3 blockPos, Vec3 color) {
-    std::uniform_real_distribution<float> pd(-0.4f, 0.4f);
-    std::uniform_real_distribution<float> vd(-2.5f, 2.5f);
-    std::uniform_real_distribution<float> vy(-0.3f, 0.5f);
-    std::uniform_real_distribution<float> rd(-0.5f, 0.5f);
-    std::uniform_real_distribution<float> sd(0.5f, 1.5f);
-    std::uniform_real_distribution<float> cv(-0.05f, 0.05f);
+// Calls emit(shape, volume) for each piece of the cell, splitting it in two
+// with a random plane now and then.
+template <typename Fn>
+static void splitCell(std::mt19937& g, const ConvexShape& cell, float vol, float halfSize, Fn&& emit) {
+    std::uniform_int_distribution<int> secondaryChance(0, SECONDARY_FRACTURE_CHANCE);
+    if (secondaryChance(g) == 0 && vol > 0.01f) {
+        Vec3 center = shapeCenter(cell);
+        Vec3 subSeed1 = perturbPoint(g, center, halfSize * 0.3f);
+        Vec3 subSeed2 = perturbPoint(g, center, halfSize * 0.3f);
+        Vec3 subMid = (subSeed1 + subSeed2) * 0.5f;
+        Vec3 subDir = (subSeed1 - subSeed2).normalized();
+        ConvexShape half;
+        for (int p = 0; p < 2; p++) {
+            if (!clipShapeByPlane(cell, subMid, p ? -subDir : subDir, half)) continue;
+            float sv = shapeVolume(half);
+            if (sv >= 0.0003f) emit(half, sv);
+        }
+        return;
+    }
+    emit(cell, vol);
+}
 
-    for (int i = 0; i < MICRO_PARTICLES; i++) {
-        Fragment fr;
-        fr.position = {
-            blockPos.x + pd(rng),
-            blockPos.y + pd(rng),
-            blockPos.z + pd(rng)
-        };
-        fr.velocity = {vd(rng), vy(rng), vd(rng)};
-        fr.rotation = {0, 0, 0};
-        fr.rotSpeed = {rd(rng), rd(rng), rd(rng)};
-        fr.color = color;
-
-        float s = MICRO_SIZE * sd(rng);
-        float hs = s * 0.5f;
-
-        Vec3 chipCol = {
-            clampf(color.x * 0.65f + cv(rng), 0, 1),
-            clampf(color.y * 0.65f + cv(rng), 0, 1),
-            clampf(color.z * 0.65f + cv(rng), 0, 1)
-        };
+// ---------------------------------------------------------------------------
+// Pattern library: a handful of Voronoi fractures of the unit cube, meshed in
+// white once. A pattern break reuses those meshes, tinted with the block colour
+// and turned by one of the 24 rotations that map the cube onto itself, so it
+// costs a table lookup and a transform per piece.
 
-        std::uniform_real_distribution<float> jit(-hs * 0.3f, hs * 0.3f);
-        Vec3 cc[8];
-        float bx[8] = {-1,1,1,-1,-1,1,1,-1};
-        float by[8] = {-1,-1,1,1,-1,-1,1,1};
-        float bz[8] = {-1,-1,-1,-1,1,1,1,1};
-        for (int k = 0; k < 8; k++) {
-            cc[k] = {bx[k]*hs + jit(rng), by[k]*hs + jit(rng), bz[k]*hs + jit(rng)};
-        }
+static const int FRACTURE_PATTERN_COUNT = 12;
+static const uint32_t FRACTURE_PATTERN_SEED = 0xF5AC7u;
 
-        struct FD { int v[4]; Vec3 n; };
-        FD ff[6] = {
-            {{0,3,2,1},{0,0,-1}},{{4,5,6,7},{0,0,1}},
-            {{0,4,7,3},{-1,0,0}},{{1,2,6,5},{1,0,0}},
-            {{0,1,5,4},{0,-1,0}},{{3,7,6,2},{0,1,0}}
-        };
-        for (int f = 0; f < 6; f++) {
-            uint32_t base = (uint32_t)fr.vertices.size();
-            for (int v = 0; v < 4; v++)
-                fr.vertices.push_back({cc[ff[f].v[v]], ff[f].n, chipCol});
-            fr.indices.push_back(base); fr.indices.push_back(base+1); fr.indices.push_back(base+2);
-            fr.indices.push_back(base); fr.indices.push_back(base+2); fr.indices.push_back(base+3);
+struct FracturePiece {
+    int mesh;
+    Vec3 center;
+};
+
+struct FracturePattern {
+    std::vector<FracturePiece> pieces;
+};
+
+static std::vector<FracturePattern> fracturePatterns;
+static Vec3 cubeRotations[24];
+static bool useFracturePatterns = true;
+
+// CPU copy of rotateXYZ in SHADERS/instanced.glsl.
+static Vec3 rotateEuler(Vec3 p, Vec3 r) {
+    float cx = cosf(r.x), sx = sinf(r.x), cy = cosf(r.y), sy = sinf(r.y), cz = cosf(r.z), sz = sinf(r.z);
+    p = {p.x, p.y * cx - p.z * sx, p.y * sx + p.z * cx};
+    p = {p.x * cy + p.z * sy, p.y, -p.x * sy + p.z * cy};
+    p = {p.x * cz - p.y * sz, p.x * sz + p.y * cz, p.z};
+    return p;
+}
+
+// The 24 proper rotations of the cube, as Euler angles in quarter turns.
+static void initCubeRotations() {
+    int found = 0;
+    int keys[24];
+    for (int a = 0; a < 4 && found < 24; a++)
+    for (int b = 0; b < 4 && found < 24; b++)
+    for (int c = 0; c < 4 && found < 24; c++) {
+        Vec3 r = {a * PI * 0.5f, b * PI * 0.5f, c * PI * 0.5f};
+        Vec3 ex = rotateEuler({1, 0, 0}, r), ey = rotateEuler({0, 1, 0}, r);
+        int key = (int)lroundf(ex.x) * 9 + (int)lroundf(ex.y) * 3 + (int)lroundf(ex.z) + 13;
+        key = key * 27 + (int)lroundf(ey.x) * 9 + (int)lroundf(ey.y) * 3 + (int)lroundf(ey.z) + 13;
+        bool dup = false;
+        for (int k = 0; k < found; k++) if (keys[k] == key) { dup = true; break; }
+        if (dup) continue;
+        keys[found] = key;
+        cubeRotations[found++] = r;
+    }
+}
+
+static void initFracturePatterns() {
+    if (!fracturePatterns.empty()) return;
+    initCubeRotations();
+    std::mt19937 g(FRACTURE_PATTERN_SEED);
+    std::uniform_int_distribution<int> numPieces(FRACTURE_MIN_PIECES, FRACTURE_MAX_PIECES);
+    const float halfSize = 0.5f;
+    fracturePatterns.resize(FRACTURE_PATTERN_COUNT);
+    for (FracturePattern& pat : fracturePatterns) {
+        Vec3 seeds[FRACTURE_MAX_PIECES];
+        int count = numPieces(g);
+        for (int i = 0; i < count; i++) seeds[i] = randomPointInCube(g, {0, 0, 0}, halfSize * 0.85f);
+        for (int i = 0; i < count; i++) {
+            ConvexShape cell;
+            if (!voronoiCell(g, seeds, count, i, {0, 0, 0}, halfSize, 0, cell)) continue;
+            float vol = shapeVolume(cell);
+            if (vol < 0.0003f) continue;
+            splitCell(g, cell, vol, halfSize, [&](const ConvexShape& piece, float) {
+                Vec3 c = shapeCenter(piece);
+                pat.pieces.push_back({shapeMesh(g, piece, c, {1, 1, 1}), c});
+            });
         }
+    }
+}
 
-        fr.scale = {1, 1, 1};
-        fr.lifetime = 0;
-        fr.maxLifetime = 8.0f;
-        fr.eternal = fragmentsEternal;
-        fr.active = true;
-        fragments.push_back(fr);
+// A break in flight. Submitting it only copies what the worker needs; the
+// worker fills `fragments` (and `meshes` for procedural breaks), and the main
+// thread publishes the result a fixed number of ticks later. The mesh library
+// and the fragment and particle stores are only ever touched on publish.
+struct FractureJob {
+    Vec3 position, color;
+    bool patterns;
+    std::mt19937 rng;
+    uint64_t dueTick;
+    JobCounter done;
+    // Pattern breaks: fr.mesh is a library mesh, retained on publish.
+    // Procedural breaks: fr.mesh indexes `meshes`, created on publish.
+    std::vector<Fragment> fragments;
+    std::vector<PieceGeometry> meshes;
+};
+
+// Ticks between a break and its debris appearing. Publishing on a fixed tick
+// rather than whenever the worker finishes keeps replays identical on any
+// thread count; the delay gives the workers time so the wait is usually free.
+static const int FRACTURE_PUBLISH_DELAY = 2;
+
+static std::deque<std::unique_ptr<FractureJob>> fractureJobs;
+static uint64_t fractureTick = 0;
+
+static void launchFragment(std::mt19937& g, Fragment& fr, Vec3 blockCenter, float spin) {
+    std::uniform_real_distribution<float> rd(-0.5f, 0.5f);
+    Vec3 away = fr.position - blockCenter;
+    float len = away.length();
+    if (len > 0.01f) away = away * (1.0f / len);
+    else away = {rd(g), 0, rd(g)};
+    fr.velocity = {
+        away.x * 1.0f + rd(g) * 0.4f,
+        rd(g) * 0.15f,
+        away.z * 1.0f + rd(g) * 0.4f
+    };
+    fr.rotSpeed = {rd(g) * spin, rd(g) * spin, rd(g) * spin};
+}
+
+static void fracturePattern(FractureJob& job) {
+    std::mt19937& g = job.rng;
+    std::uniform_int_distribution<int> pick(0, FRACTURE_PATTERN_COUNT - 1), turn(0, 23);
+    std::uniform_real_distribution<float> jitter(-0.02f, 0.02f), shrink(0.94f, 1.0f);
+    const FracturePattern& pat = fracturePatterns[pick(g)];
+    Vec3 rot = cubeRotations[turn(g)];
+    for (const FracturePiece& piece : pat.pieces) {
+        Fragment fr;
+        Vec3 offset = rotateEuler(piece.center * BLOCK_SIZE, rot);
+        fr.position = job.position + offset + Vec3{jitter(g), jitter(g), jitter(g)};
+        fr.rotation = rot;
+        fr.color = job.color;
+        fr.tint = job.color;
+        float s = BLOCK_SIZE * shrink(g);
+        fr.scale = {s, s, s};
+        fr.mesh = piece.mesh;
+        launchFragment(g, fr, job.position, 0.25f);
+        job.fragments.push_back(fr);
     }
 }
 
-static void fractureAndSpawn(Block& bl) {
+// Fresh Voronoi fracture with its own meshes, for variety the pattern library
+// cannot give.
+static void fractureProcedural(FractureJob& job) {
+    std::mt19937& g = job.rng;
     float halfSize = BLOCK_SIZE * 0.5f;
-    Vec3 blockCenter = bl.position;
+    Vec3 blockCenter = job.position;
 
     std::uniform_int_distribution<int> numPieces(FRACTURE_MIN_PIECES, FRACTURE_MAX_PIECES);
-    int pieceCount = numPieces(rng);
+    int pieceCount = numPieces(g);
 
-    std::vector<Vec3> seeds;
+    Vec3 seeds[FRACTURE_MAX_PIECES];
     for (int i = 0; i < pieceCount; i++)
-        seeds.push_back(randomPointInCube(blockCenter, halfSize * 0.85f));
-
-    std::uniform_real_distribution<float> rd(-0.5f, 0.5f);
-    std::uniform_real_distribution<float> jitter(-0.025f, 0.025f);
-    std::uniform_int_distribution<int> secondaryChance(0, SECONDARY_FRACTURE_CHANCE);
+        seeds[i] = randomPointInCube(g, blockCenter, halfSize * 0.85f);
 
     for (int i = 0; i < pieceCount; i++) {
-        ConvexShape piece = makeCubeShape(blockCenter, halfSize);
-
-        for (int j = 0; j < pieceCount; j++) {
-            if (i == j) continue;
-            Vec3 mid = (seeds[i] + seeds[j]) * 0.5f;
-            Vec3 dir = (seeds[i] - seeds[j]).normalized();
-            mid.x += jitter(rng);
-            mid.y += jitter(rng);
-            mid.z += jitter(rng);
-            piece = clipShapeByPlane(piece, mid, dir);
-            if (piece.faces.empty()) break;
-        }
-
-        if (piece.faces.empty()) continue;
-        float vol = shapeVolume(piece);
+        ConvexShape cell;
+        if (!voronoiCell(g, seeds, pieceCount, i, blockCenter, halfSize, 0.025f, cell)) continue;
+        float vol = shapeVolume(cell);
         if (vol < 0.0003f) continue;
+        splitCell(g, cell, vol, halfSize, [&](const ConvexShape& piece, float) {
+            Fragment fr;
+            fr.position = shapeCenter(piece);
+            fr.rotation = {0, 0, 0};
+            fr.color = job.color;
+            fr.scale = {1, 1, 1};
+            fr.mesh = (int)job.meshes.size();
+            job.meshes.emplace_back();
+            shapeGeometry(g, piece, fr.position, job.color, job.meshes.back());
+            launchFragment(g, fr, blockCenter, 0.25f);
+            job.fragments.push_back(fr);
+        });
+    }
+}
 
-        Vec3 center = shapeCenter(piece);
-        Vec3 awayDir = (center - blockCenter);
-        float awayLen = awayDir.length();
-        if (awayLen > 0.01f) awayDir = awayDir * (1.0f / awayLen);
-        else awayDir = {rd(rng), 0, rd(rng)};
-
-        if (secondaryChance(rng) == 0 && vol > 0.01f) {
-            Vec3 subSeed1 = perturbPoint(center, halfSize * 0.3f);
-            Vec3 subSeed2 = perturbPoint(center, halfSize * 0.3f);
-            Vec3 subMid = (subSeed1 + subSeed2) * 0.5f;
-            Vec3 subDir = (subSeed1 - subSeed2).normalized();
-
-            ConvexShape half1 = clipShapeByPlane(piece, subMid, subDir);
-            ConvexShape half2 = clipShapeByPlane(piece, subMid, Vec3{0,0,0} - subDir);
-
-            ConvexShape parts[2] = {half1, half2};
-            for (int p = 0; p < 2; p++) {
-                if (parts[p].faces.empty()) continue;
-                float sv = shapeVolume(parts[p]);
-                if (sv < 0.0003f) continue;
-
-                Vec3 sc = shapeCenter(parts[p]);
-                Vec3 ad = (sc - blockCenter);
-                float al = ad.length();
-                if (al > 0.01f) ad = ad * (1.0f / al);
-
-                Fragment fr;
-                fr.position = sc;
-                fr.velocity = {
-                    ad.x * 1.0f + rd(rng) * 0.4f,
-                    rd(rng) * 0.15f,
-                    ad.z * 1.0f + rd(rng) * 0.4f
-                };
-                fr.rotation = {0, 0, 0};
-                fr.rotSpeed = {rd(rng) * 0.2f, rd(rng) * 0.2f, rd(rng) * 0.2f};
-                fr.color = bl.color;
-                fr.scale = {1, 1, 1};
-                shapeToMesh(parts[p], sc, bl.color, fr.vertices, fr.indices);
-                addEdgeCracks(parts[p], sc, bl.color, fr.vertices, fr.indices);
-                fr.lifetime = 0;
-                fr.maxLifetime = fragmentTimeout;
-                fr.eternal = fragmentsEternal;
-                fr.active = true;
-                fragments.push_back(fr);
-            }
-            continue;
-        }
-
-        Fragment fr;
-        fr.position = center;
-        fr.velocity = {
-            awayDir.x * 1.0f + rd(rng) * 0.4f,
-            rd(rng) * 0.15f,
-            awayDir.z * 1.0f + rd(rng) * 0.4f
-        };
-        fr.rotation = {0, 0, 0};
-        fr.rotSpeed = {rd(rng) * 0.25f, rd(rng) * 0.25f, rd(rng) * 0.25f};
-        fr.color = bl.color;
-        fr.scale = {1, 1, 1};
+static void runFractureJob(FractureJob& job) {
+    job.fragments.reserve(2 * FRACTURE_MAX_PIECES);
+    if (!job.patterns) job.meshes.reserve(2 * FRACTURE_MAX_PIECES);
+    if (job.patterns) fracturePattern(job);
+    else fractureProcedural(job);
+}
 
-        shapeToMesh(piece, center, bl.color, fr.vertices, fr.indices);
-        addEdgeCracks(piece, center, bl.color, fr.vertices, fr.indices);
+// Starts breaking `bl` on a worker. Each job gets its own RNG stream, seeded
+// from rng on the main thread, so the debris does not depend on which worker
+// ran it or when.
+static void submitFracture(const Block& bl) {
+    initFracturePatterns();
+    std::unique_ptr<FractureJob> job(new FractureJob());
+    job->position = bl.position;
+    job->color = bl.color;
+    job->patterns = useFracturePatterns;
+    job->rng.seed(rng());
+    job->dueTick = fractureTick + FRACTURE_PUBLISH_DELAY;
+    FractureJob* j = job.get();
+    fractureJobs.push_back(std::move(job));
+    submitJob([j] { runFractureJob(*j); }, j->done);
+}
 
+static void publishFracture(FractureJob& job) {
+    waitJobs(job.done);
+    for (Fragment& fr : job.fragments) {
+        if (job.patterns) retainMesh(fr.mesh);
+        else {
+            PieceGeometry& geo = job.meshes[fr.mesh];
+            fr.mesh = createMesh(std::move(geo.verts), std::move(geo.inds));
+        }
         fr.lifetime = 0;
         fr.maxLifetime = fragmentTimeout;
         fr.eternal = fragmentsEternal;
         fr.active = true;
-        fragments.push_back(fr);
+        spawnFragment(fr);
+    }
+    spawnMicroParticles(job.rng, job.position, job.color);
+    spawnDustCloud(job.rng, job.position, job.color);
+}
+
+// Once per simulation tick, before fragments move: spawns the debris of every
+// break that has come due, in the order the blocks were broken.
+static void publishFractureJobs() {
+    fractureTick++;
+    while (!fractureJobs.empty() && fractureJobs.front()->dueTick <= fractureTick) {
+        publishFracture(*fractureJobs.front());
+        fractureJobs.pop_front();
+    }
+}
+
+// Publishes every pending break now, due or not.
+static void flushFractureJobs() {
+    while (!fractureJobs.empty()) {
+        publishFracture(*fractureJobs.front());
+        fractureJobs.pop_front();
     }
+}
 
-    spawnMicroParticles(blockCenter, bl.color);
-    spawnDustCloud(blockCenter, bl.color);
+static void fractureAndSpawn(const Block& bl) {
+    submitFracture(bl);
+    flushFractureJobs();
 }
\ No newline at end of file
@@ -1 +1,244 @@
-#pragma once
\ No newline at end of file
+#pragma once
+
+// Dust and chips from a broken block. They are too small and too many to be
+// Fragments: each one is a row in fixed-capacity SoA arrays and points at one
+// of a few shared meshes, so spawning them never touches the allocator.
+
+static const int MICRO_PARTICLES = 25;
+static const int DUST_PARTICLES = 40;
+static const float MICRO_SIZE = 0.035f;
+static const float DUST_SIZE = 0.015f;
+static const int MAX_PARTICLES = 1 << 15;
+static const int CHIP_VARIANTS = 4;
+static const float PARTICLE_COLLISION_SIZE = 1.0f;
+static const float DUST_LIFETIME = 5.0f;
+static const float MICRO_LIFETIME = 8.0f;
+
+enum ParticleVariant { PARTICLE_DUST = 0, PARTICLE_CHIP = 1 };
+
+struct ParticleStore {
+    float px[MAX_PARTICLES], py[MAX_PARTICLES], pz[MAX_PARTICLES];
+    float ox[MAX_PARTICLES], oy[MAX_PARTICLES], oz[MAX_PARTICLES];
+    float vx[MAX_PARTICLES], vy[MAX_PARTICLES], vz[MAX_PARTICLES];
+    float rx[MAX_PARTICLES], ry[MAX_PARTICLES], rz[MAX_PARTICLES];
+    float wx[MAX_PARTICLES], wy[MAX_PARTICLES], wz[MAX_PARTICLES];
+    float size[MAX_PARTICLES], age[MAX_PARTICLES], maxAge[MAX_PARTICLES];
+    float tr[MAX_PARTICLES], tg[MAX_PARTICLES], tb[MAX_PARTICLES];
+    uint8_t variant[MAX_PARTICLES], eternal[MAX_PARTICLES], onGround[MAX_PARTICLES];
+    int count = 0;
+};
+
+static ParticleStore* particles = nullptr;
+static int particleMeshes[1 + CHIP_VARIANTS] = {-1, -1, -1, -1, -1};
+
+// Unit cube with white vertices; the instance scale and tint give each
+// particle its size and colour. Chips get their corners jittered.
+static int makeParticleMesh(std::mt19937& g, float jitter) {
+    std::uniform_real_distribution<float> jit(-jitter, jitter);
+    Vec3 cc[8];
+    float bx[8] = {-1,1,1,-1,-1,1,1,-1};
+    float by[8] = {-1,-1,1,1,-1,-1,1,1};
+    float bz[8] = {-1,-1,-1,-1,1,1,1,1};
+    for (int k = 0; k < 8; k++)
+        cc[k] = {bx[k] * 0.5f + jit(g), by[k] * 0.5f + jit(g), bz[k] * 0.5f + jit(g)};
+
+    struct FD { int v[4]; Vec3 n; };
+    FD ff[6] = {
+        {{0,3,2,1},{0,0,-1}},{{4,5,6,7},{0,0,1}},
+        {{0,4,7,3},{-1,0,0}},{{1,2,6,5},{1,0,0}},
+        {{0,1,5,4},{0,-1,0}},{{3,7,6,2},{0,1,0}}
+    };
+    std::vector<Vertex> V;
+    std::vector<uint32_t> I;
+    for (int f = 0; f < 6; f++) {
+        uint32_t base = (uint32_t)V.size();
+        for (int v = 0; v < 4; v++)
+            V.push_back({cc[ff[f].v[v]], ff[f].n, {1, 1, 1}});
+        I.push_back(base); I.push_back(base+1); I.push_back(base+2);
+        I.push_back(base); I.push_back(base+2); I.push_back(base+3);
+    }
+    return createMesh(std::move(V), std::move(I));
+}
+
+static void initParticles() {
+    if (particles) return;
+    particles = new ParticleStore();
+    std::mt19937 g(7);
+    particleMeshes[PARTICLE_DUST] = makeParticleMesh(g, 0);
+    for (int i = 0; i < CHIP_VARIANTS; i++)
+        particleMeshes[PARTICLE_CHIP + i] = makeParticleMesh(g, 0.15f);
+}
+
+static void addParticle(Vec3 pos, Vec3 vel, Vec3 spin, float size, Vec3 tint, int variant, float lifetime) {
+    ParticleStore& p = *particles;
+    if (p.count >= MAX_PARTICLES) return;
+    int i = p.count++;
+    p.px[i] = pos.x; p.py[i] = pos.y; p.pz[i] = pos.z;
+    p.ox[i] = pos.x; p.oy[i] = pos.y; p.oz[i] = pos.z;
+    p.vx[i] = vel.x; p.vy[i] = vel.y; p.vz[i] = vel.z;
+    p.rx[i] = 0; p.ry[i] = 0; p.rz[i] = 0;
+    p.wx[i] = spin.x; p.wy[i] = spin.y; p.wz[i] = spin.z;
+    p.size[i] = size;
+    p.age[i] = 0;
+    p.maxAge[i] = lifetime;
+    p.tr[i] = tint.x; p.tg[i] = tint.y; p.tb[i] = tint.z;
+    p.variant[i] = (uint8_t)variant;
+    p.eternal[i] = fragmentsEternal ? 1 : 0;
+}
+
+static void removeParticle(int i) {
+    ParticleStore& p = *particles;
+    int last = --p.count;
+    if (i == last) return;
+    p.px[i] = p.px[last]; p.py[i] = p.py[last]; p.pz[i] = p.pz[last];
+    p.ox[i] = p.ox[last]; p.oy[i] = p.oy[last]; p.oz[i] = p.oz[last];
+    p.vx[i] = p.vx[last]; p.vy[i] = p.vy[last]; p.vz[i] = p.vz[last];
+    p.rx[i] = p.rx[last]; p.ry[i] = p.ry[last]; p.rz[i] = p.rz[last];
+    p.wx[i] = p.wx[last]; p.wy[i] = p.wy[last]; p.wz[i] = p.wz[last];
+    p.size[i] = p.size[last];
+    p.age[i] = p.age[last];
+    p.maxAge[i] = p.maxAge[last];
+    p.tr[i] = p.tr[last]; p.tg[i] = p.tg[last]; p.tb[i] = p.tb[last];
+    p.variant[i] = p.variant[last];
+    p.eternal[i] = p.eternal[last];
+    p.onGround[i] = p.onGround[last];
+}
+
+static void spawnDustCloud(std::mt19937& g, Vec3 blockPos, Vec3 color) {
+    initParticles();
+    std::uniform_real_distribution<float> pd(-0.45f, 0.45f);
+    std::uniform_real_distribution<float> vd(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> vy(0.0f, 0.8f);
+    std::uniform_real_distribution<float> sd(0.6f, 1.4f);
+    std::uniform_real_distribution<float> cv(-0.04f, 0.04f);
+
+    for (int i = 0; i < DUST_PARTICLES; i++) {
+        Vec3 pos = {blockPos.x + pd(g), blockPos.y + pd(g), blockPos.z + pd(g)};
+        Vec3 vel = {vd(g), vy(g), vd(g)};
+        Vec3 spin = {vd(g) * 0.2f, vd(g) * 0.2f, vd(g) * 0.2f};
+        float s = DUST_SIZE * sd(g);
+        Vec3 dustCol = {
+            clampf(color.x * 0.8f + cv(g), 0, 1),
+            clampf(color.y * 0.8f + cv(g), 0, 1),
+            clampf(color.z * 0.8f + cv(g), 0, 1)
+        };
+        addParticle(pos, vel, spin, s, dustCol, PARTICLE_DUST, DUST_LIFETIME);
+    }
+}
+
+static void spawnMicroParticles(std::mt19937& g, Vec3 blockPos, Vec3 color) {
+    initParticles();
+    std::uniform_real_distribution<float> pd(-0.4f, 0.4f);
+    std::uniform_real_distribution<float> vd(-2.5f, 2.5f);
+    std::uniform_real_distribution<float> vy(-0.3f, 0.5f);
+    std::uniform_real_distribution<float> rd(-0.5f, 0.5f);
+    std::uniform_real_distribution<float> sd(0.5f, 1.5f);
+    std::uniform_real_distribution<float> cv(-0.05f, 0.05f);
+    std::uniform_int_distribution<int> vr(0, CHIP_VARIANTS - 1);
+
+    for (int i = 0; i < MICRO_PARTICLES; i++) {
+        Vec3 pos = {blockPos.x + pd(g), blockPos.y + pd(g), blockPos.z + pd(g)};
+        Vec3 vel = {vd(g), vy(g), vd(g)};
+        Vec3 spin = {rd(g), rd(g), rd(g)};
+        float s = MICRO_SIZE * sd(g);
+        Vec3 chipCol = {
+            clampf(color.x * 0.65f + cv(g), 0, 1),
+            clampf(color.y * 0.65f + cv(g), 0, 1),
+            clampf(color.z * 0.65f + cv(g), 0, 1)
+        };
+        addParticle(pos, vel, spin, s, chipCol, PARTICLE_CHIP + vr(g), MICRO_LIFETIME);
+    }
+}
+
+// Same step as fragments. Collision uses the unit size the particles had
+// when they were Fragments with scale 1.
+static void updateParticles(float dt) {
+    if (!particles) return;
+    ParticleStore& p = *particles;
+    BodyArrays b;
+    b.px = p.px; b.py = p.py; b.pz = p.pz;
+    b.vx = p.vx; b.vy = p.vy; b.vz = p.vz;
+    b.rx = p.rx; b.ry = p.ry; b.rz = p.rz;
+    b.wx = p.wx; b.wy = p.wy; b.wz = p.wz;
+    b.extent = nullptr;
+    b.uniformExtent = PARTICLE_COLLISION_SIZE;
+    b.onGround = p.onGround;
+    b.contact = nullptr;
+    b.restTime = nullptr;
+    b.ax = b.ay = b.az = nullptr;
+    b.count = p.count;
+    parallelFor(p.count, PHYS_JOB_GRAIN, [&](int begin, int end) {
+        size_t n = (size_t)(end - begin) * sizeof(float);
+        memcpy(p.ox + begin, p.px + begin, n);
+        memcpy(p.oy + begin, p.py + begin, n);
+        memcpy(p.oz + begin, p.pz + begin, n);
+        integrateBodies(b, begin, end, dt);
+        for (int i = begin; i < end; i++) {
+            settleBody(b, i, dt);
+            if (!p.eternal[i]) p.age[i] += dt;
+        }
+    });
+
+    for (int i = 0; i < p.count; i++) {
+        if ((!p.eternal[i] && p.age[i] >= p.maxAge[i]) || p.py[i] < -50.0f) {
+            removeParticle(i);
+            i--;
+        }
+    }
+}
+
+static void setParticlesEternal(bool eternal) {
+    if (!particles) return;
+    ParticleStore& p = *particles;
+    for (int i = 0; i < p.count; i++) {
+        p.eternal[i] = eternal ? 1 : 0;
+        if (!eternal) p.age[i] = 0;
+    }
+}
+
+static void clearParticles() {
+    if (particles) particles->count = 0;
+}
+
+static int particleCount() {
+    return particles ? particles->count : 0;
+}
+
+// Appends one batch per mesh variant; particles are bucketed by variant with a
+// counting pass so no sort is needed. Positions are blended from the previous
+// tick by `alpha`; chips spin too slowly for their rotation to need it. With
+// a frustum, particles outside it are skipped.
+static void buildParticleInstances(std::vector<InstanceData>& out, std::vector<InstanceBatch>& batches, float alpha, const Frustum* frustum = nullptr) {
+    if (!particles || particles->count == 0) return;
+    const ParticleStore& p = *particles;
+    const int nv = 1 + CHIP_VARIANTS;
+    uint32_t start[1 + CHIP_VARIANTS] = {};
+    uint32_t fill[1 + CHIP_VARIANTS] = {};
+    ArenaScope scratch(frameArena);
+    ArenaVector<uint32_t> keep{ArenaAllocator<uint32_t>(frameArena)};
+    keep.reserve(p.count);
+    for (int i = 0; i < p.count; i++) {
+        if (frustum) {
+            Vec3 pos = {p.ox[i] + (p.px[i] - p.ox[i]) * alpha, p.oy[i] + (p.py[i] - p.oy[i]) * alpha, p.oz[i] + (p.pz[i] - p.oz[i]) * alpha};
+            cullStats.particlesTested++;
+            if (!frustum->sphereVisible(pos, meshLibrary[particleMeshes[p.variant[i]]].radius * p.size[i])) { cullStats.particlesCulled++; continue; }
+        }
+        keep.push_back((uint32_t)i);
+        start[p.variant[i]]++;
+    }
+    uint32_t base = (uint32_t)out.size();
+    uint32_t run = base;
+    for (int v = 0; v < nv; v++) {
+        uint32_t n = start[v];
+        if (n) batches.push_back({particleMeshes[v], run, n});
+        start[v] = run;
+        run += n;
+    }
+    out.resize(base + keep.size());
+    for (uint32_t i : keep) {
+        int v = p.variant[i];
+        float s = p.size[i];
+        Vec3 pos = {p.ox[i] + (p.px[i] - p.ox[i]) * alpha, p.oy[i] + (p.py[i] - p.oy[i]) * alpha, p.oz[i] + (p.pz[i] - p.oz[i]) * alpha};
+        out[start[v] + fill[v]++] = {pos, {p.rx[i], p.ry[i], p.rz[i]}, {s, s, s}, {p.tr[i], p.tg[i], p.tb[i]}};
+    }
+}
\ No newline at end of file
@@ -11,6 +11,17 @@ static const float PHYS_GROUND_Y = -0.3f;
 static const float PHYS_TERMINAL_VELOCITY = 20.0f;
 static const float PHYS_MAX_ANGULAR_SPEED = 3.0f;
 static const float PHYS_SPIN_TRANSFER = 0.08f;
+static const int PHYS_JOB_GRAIN = 512;
+static const float PHYS_SLEEP_VELOCITY = 0.15f;
+static const float PHYS_SLEEP_ANGULAR = 0.15f;
+static const float PHYS_SLEEP_DELAY = 0.5f;
+static const float PHYS_SLEEP_DRIFT = 0.05f;
+static const float PHYS_WAKE_RADIUS = 1.5f;
+static const float PHYS_COLLISION_SHRINK = 0.75f;
+static const float PHYS_CONTACT_RELAX = 0.8f;
+static const float PHYS_CONTACT_FRICTION = 0.1f;
+static const float PHYS_WAKE_IMPACT = 0.8f;
+static const float PHYS_SUPPORT_NORMAL = 0.7f;
 
 static void clampAngularSpeed(Vec3& rotSpeed) {
     if (rotSpeed.x > PHYS_MAX_ANGULAR_SPEED) rotSpeed.x = PHYS_MAX_ANGULAR_SPEED;
@@ -122,51 +133,562 @@ static bool handleBlockCollision(Vec3& pos, Vec3& vel, Vec3& rotSpeed, float fra
     return false;
 }
 
-static void updateFragmentPhysics(Fragment& fr, float dt) {
-    if (!fr.active) return;
+// Raw per-body arrays shared by fragments and particles. The integration,
+// drag and ground-plane part of the step runs over these in SIMD lanes; block
+// collision, friction and rotation then run per body.
+struct BodyArrays {
+    float *px, *py, *pz;
+    float *vx, *vy, *vz;
+    float *rx, *ry, *rz;
+    float *wx, *wy, *wz;
+    const float* extent;
+    float uniformExtent;
+    uint8_t* onGround;
+    const uint8_t* contact;
+    float* restTime;
+    float *ax, *ay, *az;
+    int count;
+};
 
-    applyGravity(fr.velocity, dt);
-    applyAirDrag(fr.velocity, dt);
+static void integrateBodyScalar(BodyArrays& b, int i, float dt) {
+    Vec3 pos = {b.px[i], b.py[i], b.pz[i]};
+    Vec3 vel = {b.vx[i], b.vy[i], b.vz[i]};
+    Vec3 spin = {b.wx[i], b.wy[i], b.wz[i]};
 
-    fr.position.x += fr.velocity.x * dt;
-    fr.position.y += fr.velocity.y * dt;
-    fr.position.z += fr.velocity.z * dt;
+    applyGravity(vel, dt);
+    applyAirDrag(vel, dt);
+    pos += vel * dt;
+    float ext = b.extent ? b.extent[i] : b.uniformExtent;
+    b.onGround[i] = handleGroundCollision(pos, vel, spin, ext) ? 1 : 0;
 
-    float fragSize = (fr.scale.x + fr.scale.y + fr.scale.z) / 3.0f;
+    b.px[i] = pos.x; b.py[i] = pos.y; b.pz[i] = pos.z;
+    b.vx[i] = vel.x; b.vy[i] = vel.y; b.vz[i] = vel.z;
+    b.wx[i] = spin.x; b.wy[i] = spin.y; b.wz[i] = spin.z;
+}
+
+// Gravity, air drag, integration and the ground plane for every body. The
+// lanes compute exactly what applyGravity/applyAirDrag/handleGroundCollision
+// do, with branches turned into masks; the tail and non-SSE builds use them
+// directly.
+static void integrateBodies(BodyArrays& b, int begin, int end, float dt) {
+    int i = begin;
+#if defined(__SSE2__)
+    const simdf vdt = simdSet(dt), one = simdSet(1.0f);
+    const simdf gdt = simdSet(PHYS_GRAVITY * dt), term = simdSet(-PHYS_TERMINAL_VELOCITY);
+    const simdf dragDt = simdSet(PHYS_AIR_DRAG * dt), minSpeed = simdSet(0.001f);
+    const simdf groundY = simdSet(PHYS_GROUND_Y), half = simdSet(0.5f);
+    const simdf bounceV = simdSet(-0.3f), bounceK = simdSet(-PHYS_BOUNCE_DAMPING), slide = simdSet(0.7f);
+    const simdf spinMin = simdSet(0.1f), spinK = simdSet(PHYS_SPIN_TRANSFER);
+    const simdf maxSpin = simdSet(PHYS_MAX_ANGULAR_SPEED), minSpin = simdSet(-PHYS_MAX_ANGULAR_SPEED);
+    const simdf uniformExt = simdSet(b.uniformExtent);
+    for (; i + SIMD_WIDTH <= end; i += SIMD_WIDTH) {
+        simdf vx = simdLoad(b.vx + i), vy = simdLoad(b.vy + i), vz = simdLoad(b.vz + i);
+        simdf wx = simdLoad(b.wx + i), wy = simdLoad(b.wy + i), wz = simdLoad(b.wz + i);
+
+        vy = simdMax(simdSub(vy, gdt), term);
+
+        simdf speed = simdSqrt(simdAdd(simdAdd(simdMul(vx, vx), simdMul(vy, vy)), simdMul(vz, vz)));
+        simdf drag = simdSub(one, simdMin(simdMul(dragDt, speed), one));
+        drag = simdSelect(simdLess(speed, minSpeed), one, drag);
+        vx = simdMul(vx, drag); vy = simdMul(vy, drag); vz = simdMul(vz, drag);
+
+        simdf px = simdAdd(simdLoad(b.px + i), simdMul(vx, vdt));
+        simdf py = simdAdd(simdLoad(b.py + i), simdMul(vy, vdt));
+        simdf pz = simdAdd(simdLoad(b.pz + i), simdMul(vz, vdt));
+
+        simdf ext = b.extent ? simdLoad(b.extent + i) : uniformExt;
+        simdf level = simdAdd(groundY, simdMul(ext, half));
+        simdf hit = simdLessEq(py, level);
+        int hitBits = simdMask(hit);
+        if (hitBits) {
+            py = simdSelect(hit, level, py);
+            simdf bounce = simdAnd(hit, simdLess(vy, bounceV));
+            simdf bx = simdMul(vx, slide), bz = simdMul(vz, slide);
+            simdf bwx = simdMul(wx, half), bwy = simdMul(wy, half), bwz = simdMul(wz, half);
+            simdf hs = simdSqrt(simdAdd(simdMul(bx, bx), simdMul(bz, bz)));
+            simdf spinOn = simdAnd(simdLess(spinMin, hs), one);
+            bwx = simdAdd(bwx, simdMul(spinOn, simdMul(bz, spinK)));
+            bwz = simdSub(bwz, simdMul(spinOn, simdMul(bx, spinK)));
+            bwx = simdMax(simdMin(bwx, maxSpin), minSpin);
+            bwy = simdMax(simdMin(bwy, maxSpin), minSpin);
+            bwz = simdMax(simdMin(bwz, maxSpin), minSpin);
+            vy = simdSelect(bounce, simdMul(vy, bounceK), simdAndNot(hit, vy));
+            vx = simdSelect(bounce, bx, vx); vz = simdSelect(bounce, bz, vz);
+            wx = simdSelect(bounce, bwx, wx); wy = simdSelect(bounce, bwy, wy); wz = simdSelect(bounce, bwz, wz);
+        }
+        for (int k = 0; k < SIMD_WIDTH; k++) b.onGround[i + k] = (hitBits >> k) & 1;
+
+        simdStore(b.px + i, px); simdStore(b.py + i, py); simdStore(b.pz + i, pz);
+        simdStore(b.vx + i, vx); simdStore(b.vy + i, vy); simdStore(b.vz + i, vz);
+        simdStore(b.wx + i, wx); simdStore(b.wy + i, wy); simdStore(b.wz + i, wz);
+    }
+#endif
+    for (; i < end; i++) integrateBodyScalar(b, i, dt);
+}
+
+// Rest of the step for one body after integrateBodies: block collision,
+// ground friction, rotation and the rest check. restTime, when tracked, counts
+// how long the body has been touching something while either slow or staying
+// within PHYS_SLEEP_DRIFT of an anchor point; the latter catches pieces jammed
+// in a pile that keep trading small impulses.
+static void settleBody(BodyArrays& b, int i, float dt) {
+    Vec3 pos = {b.px[i], b.py[i], b.pz[i]};
+    Vec3 vel = {b.vx[i], b.vy[i], b.vz[i]};
+    Vec3 spin = {b.wx[i], b.wy[i], b.wz[i]};
+    float ext = b.extent ? b.extent[i] : b.uniformExtent;
+    bool onGnd = b.onGround[i] != 0;
+
+    bool onBlock = handleBlockCollision(pos, vel, spin, ext);
+    if (onGnd) applyGroundFriction(vel, spin, dt);
+
+    b.rx[i] += spin.x * dt;
+    b.ry[i] += spin.y * dt;
+    b.rz[i] += spin.z * dt;
+
+    if (onGnd && vel.length() < PHYS_MIN_VELOCITY && spin.length() < PHYS_MIN_ANGULAR) {
+        vel = {0, 0, 0};
+        spin = {0, 0, 0};
+    }
+
+    b.px[i] = pos.x; b.py[i] = pos.y; b.pz[i] = pos.z;
+    b.vx[i] = vel.x; b.vy[i] = vel.y; b.vz[i] = vel.z;
+    b.wx[i] = spin.x; b.wy[i] = spin.y; b.wz[i] = spin.z;
+
+    if (b.restTime) {
+        bool touching = onGnd || onBlock || (b.contact && b.contact[i]);
+        bool slow = vel.length() < PHYS_SLEEP_VELOCITY && spin.length() < PHYS_SLEEP_ANGULAR;
+        Vec3 drift = pos - Vec3{b.ax[i], b.ay[i], b.az[i]};
+        if (touching && (slow || drift.lengthSq() < PHYS_SLEEP_DRIFT * PHYS_SLEEP_DRIFT)) {
+            b.restTime[i] += dt;
+        } else {
+            b.restTime[i] = 0;
+            b.ax[i] = pos.x; b.ay[i] = pos.y; b.az[i] = pos.z;
+        }
+    }
+}
+
+static BodyArrays fragmentBodies(FragmentStore& f) {
+    BodyArrays b;
+    b.px = f.px.data(); b.py = f.py.data(); b.pz = f.pz.data();
+    b.vx = f.vx.data(); b.vy = f.vy.data(); b.vz = f.vz.data();
+    b.rx = f.rx.data(); b.ry = f.ry.data(); b.rz = f.rz.data();
+    b.wx = f.wx.data(); b.wy = f.wy.data(); b.wz = f.wz.data();
+    b.extent = f.extent.data();
+    b.uniformExtent = 1.0f;
+    b.onGround = f.onGround.data();
+    b.contact = f.contact.data();
+    b.restTime = f.restTime.data();
+    b.ax = f.ax.data(); b.ay = f.ay.data(); b.az = f.az.data();
+    b.count = (int)f.size();
+    return b;
+}
+
+// Fragments that have rested for PHYS_SLEEP_DELAY leave the simulated set and
+// are parked per chunk. Nothing touches them per step: lifetimes become an
+// absolute death time checked through a min-heap, and they only come back
+// when wakeFragmentsNear() is called for a spot close to them.
+struct SleepBucket {
+    FragmentStore frags;
+    std::vector<double> deathTime;
+};
+
+static double physicsTime = 0;
+static std::unordered_map<uint64_t, SleepBucket> sleepingFragments;
+static std::vector<std::pair<double, uint64_t>> sleepDeaths;
+static size_t sleepingCount = 0;
 
-    bool onGnd = handleGroundCollision(fr.position, fr.velocity, fr.rotSpeed, fragSize);
-    handleBlockCollision(fr.position, fr.velocity, fr.rotSpeed, fragSize);
+static uint64_t fragmentChunkKey(float x, float y, float z) {
+    return chunkKey((int)floorf(x + 0.5f) >> CHUNK_SHIFT, (int)floorf(y + 0.5f) >> CHUNK_SHIFT, (int)floorf(z + 0.5f) >> CHUNK_SHIFT);
+}
+
+static void pushSleepDeath(double t, uint64_t key) {
+    sleepDeaths.push_back({t, key});
+    std::push_heap(sleepDeaths.begin(), sleepDeaths.end(), std::greater<std::pair<double, uint64_t>>());
+}
 
-    if (onGnd) {
-        applyGroundFriction(fr.velocity, fr.rotSpeed, dt);
+static void putToSleep(FragmentStore& f, size_t i) {
+    uint64_t key = fragmentChunkKey(f.px[i], f.py[i], f.pz[i]);
+    SleepBucket& bucket = sleepingFragments[key];
+    bucket.frags.append(f, i);
+    size_t j = bucket.frags.size() - 1;
+    bucket.frags.vx[j] = bucket.frags.vy[j] = bucket.frags.vz[j] = 0;
+    bucket.frags.wx[j] = bucket.frags.wy[j] = bucket.frags.wz[j] = 0;
+    bucket.frags.settlePose(j);
+    double death = HUGE_VAL;
+    if (!f.eternal[i]) {
+        death = physicsTime + (f.maxLife[i] - f.life[i]);
+        pushSleepDeath(death, key);
     }
+    bucket.deathTime.push_back(death);
+    sleepingCount++;
+}
 
-    fr.rotation.x += fr.rotSpeed.x * dt;
-    fr.rotation.y += fr.rotSpeed.y * dt;
-    fr.rotation.z += fr.rotSpeed.z * dt;
+static void removeSleeper(SleepBucket& bucket, size_t j) {
+    size_t last = bucket.frags.size() - 1;
+    if (j != last) {
+        bucket.frags.move(j, last);
+        bucket.deathTime[j] = bucket.deathTime[last];
+    }
+    bucket.frags.resize(last);
+    bucket.deathTime.pop_back();
+    sleepingCount--;
+}
 
-    float totalSpeed = fr.velocity.length();
-    float totalSpin = fr.rotSpeed.length();
+static void wakeSleeper(SleepBucket& bucket, size_t j) {
+    FragmentStore& s = bucket.frags;
+    if (!s.eternal[j]) s.life[j] = s.maxLife[j] - (float)(bucket.deathTime[j] - physicsTime);
+    s.restTime[j] = 0;
+    s.ax[j] = s.px[j]; s.ay[j] = s.py[j]; s.az[j] = s.pz[j];
+    fragments.append(s, j);
+    removeSleeper(bucket, j);
+}
 
-    if (onGnd && totalSpeed < PHYS_MIN_VELOCITY && totalSpin < PHYS_MIN_ANGULAR) {
-        fr.velocity = {0, 0, 0};
-        fr.rotSpeed = {0, 0, 0};
+// Wakes every sleeping fragment within radius of p, e.g. around a removed block.
+static void wakeFragmentsNear(Vec3 p, float radius) {
+    if (sleepingFragments.empty()) return;
+    int r = (int)ceilf(radius);
+    int x0 = ((int)floorf(p.x + 0.5f) - r) >> CHUNK_SHIFT, x1 = ((int)floorf(p.x + 0.5f) + r) >> CHUNK_SHIFT;
+    int y0 = ((int)floorf(p.y + 0.5f) - r) >> CHUNK_SHIFT, y1 = ((int)floorf(p.y + 0.5f) + r) >> CHUNK_SHIFT;
+    int z0 = ((int)floorf(p.z + 0.5f) - r) >> CHUNK_SHIFT, z1 = ((int)floorf(p.z + 0.5f) + r) >> CHUNK_SHIFT;
+    float r2 = radius * radius;
+    for (int cx = x0; cx <= x1; cx++)
+        for (int cy = y0; cy <= y1; cy++)
+            for (int cz = z0; cz <= z1; cz++) {
+                auto it = sleepingFragments.find(chunkKey(cx, cy, cz));
+                if (it == sleepingFragments.end()) continue;
+                SleepBucket& bucket = it->second;
+                FragmentStore& s = bucket.frags;
+                for (size_t j = 0; j < s.size();) {
+                    Vec3 d = Vec3{s.px[j], s.py[j], s.pz[j]} - p;
+                    if (d.lengthSq() <= r2) wakeSleeper(bucket, j);
+                    else j++;
+                }
+                if (s.empty()) sleepingFragments.erase(it);
+            }
+}
+
+// Pops heap entries that are due and drops the expired sleepers in that
+// bucket. Entries can be stale (woken or already removed); rescanning the
+// bucket handles that.
+static void expireSleepers() {
+    auto later = std::greater<std::pair<double, uint64_t>>();
+    while (!sleepDeaths.empty() && sleepDeaths.front().first <= physicsTime) {
+        uint64_t key = sleepDeaths.front().second;
+        std::pop_heap(sleepDeaths.begin(), sleepDeaths.end(), later);
+        sleepDeaths.pop_back();
+        auto it = sleepingFragments.find(key);
+        if (it == sleepingFragments.end()) continue;
+        SleepBucket& bucket = it->second;
+        for (size_t j = 0; j < bucket.frags.size();) {
+            if (bucket.deathTime[j] <= physicsTime) { releaseMesh(bucket.frags.mesh[j]); removeSleeper(bucket, j); }
+            else j++;
+        }
+        if (bucket.frags.empty()) sleepingFragments.erase(it);
     }
+}
 
-    if (!fr.eternal) {
-        fr.lifetime += dt;
-        if (fr.lifetime >= fr.maxLifetime) fr.active = false;
+// Drops the sleepers parked anywhere in chunk column (cx, cz), e.g. when it is
+// unloaded. Their heap entries go stale and are skipped.
+static void dropSleepersInColumn(int cx, int cz) {
+    for (auto it = sleepingFragments.begin(); it != sleepingFragments.end();) {
+        int kx, ky, kz;
+        chunkKeyCoords(it->first, kx, ky, kz);
+        if (kx != cx || kz != cz) { ++it; continue; }
+        FragmentStore& s = it->second.frags;
+        for (size_t j = 0; j < s.size(); j++) releaseMesh(s.mesh[j]);
+        sleepingCount -= s.size();
+        it = sleepingFragments.erase(it);
     }
+}
+
+static size_t fragmentCount() {
+    return fragments.size() + sleepingCount;
+}
 
-    if (fr.position.y < -50.0f) fr.active = false;
+// Every store holding fragments that should be drawn: the simulated set first,
+// then each sleeping bucket.
+static void collectFragmentStores(std::vector<const FragmentStore*>& out) {
+    out.clear();
+    out.push_back(&fragments);
+    for (auto& kv : sleepingFragments) out.push_back(&kv.second.frags);
 }
 
+// Collision sphere: the mesh's bounding sphere, shrunk so convex pieces can
+// settle against each other instead of resting on their corners.
+static void spawnFragment(const Fragment& fr, float radius = -1.0f) {
+    fragments.add(fr);
+    if (radius < 0) {
+        float sc = std::max(fr.scale.x, std::max(fr.scale.y, fr.scale.z));
+        radius = fr.mesh >= 0 ? meshLibrary[fr.mesh].radius * sc * PHYS_COLLISION_SHRINK : 0.1f;
+    }
+    fragments.radius.back() = radius;
+}
+
+// Fragment-fragment contacts. Awake fragments and the sleepers in chunks next
+// to them go into a spatial hash; every awake fragment then resolves its own
+// side of each sphere overlap (Jacobi style), so bodies run in parallel
+// without sharing writes. Side contacts split the correction by mass; in a
+// near-vertical contact the lower body acts as static support for the upper
+// one, which keeps piles from jittering. Sleepers are always static. A hard
+// enough hit wakes them after the step.
+struct SleeperRef { uint64_t key; uint32_t row; };
+
+static SpatialHash fragmentHash;
+static std::vector<float> hashX, hashY, hashZ, hashR;
+static std::vector<SleeperRef> hashSleepers;
+static std::vector<SleeperRef> pendingWakes;
+static double lastCollideMs = 0;
+static size_t lastContactCount = 0;
+
+static void gatherNearbySleepers(const FragmentStore& f) {
+    hashSleepers.clear();
+    if (sleepingFragments.empty()) return;
+    ArenaScope scratch(frameArena);
+    ArenaVector<uint64_t> keys{ArenaAllocator<uint64_t>(frameArena)};
+    keys.reserve(f.size());
+    for (size_t i = 0; i < f.size(); i++) {
+        int cx = (int)floorf(f.px[i] + 0.5f) >> CHUNK_SHIFT;
+        int cy = (int)floorf(f.py[i] + 0.5f) >> CHUNK_SHIFT;
+        int cz = (int)floorf(f.pz[i] + 0.5f) >> CHUNK_SHIFT;
+        keys.push_back(chunkKey(cx, cy, cz));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    ArenaVector<uint64_t> near{ArenaAllocator<uint64_t>(frameArena)};
+    near.reserve(keys.size() * 27);
+    for (uint64_t k : keys) {
+        int cx, cy, cz;
+        chunkKeyCoords(k, cx, cy, cz);
+        for (int dx = -1; dx <= 1; dx++)
+            for (int dy = -1; dy <= 1; dy++)
+                for (int dz = -1; dz <= 1; dz++) {
+                    uint64_t nk = chunkKey(cx + dx, cy + dy, cz + dz);
+                    if (sleepingFragments.count(nk)) near.push_back(nk);
+                }
+    }
+    std::sort(near.begin(), near.end());
+    near.erase(std::unique(near.begin(), near.end()), near.end());
+    for (uint64_t k : near) {
+        const FragmentStore& s = sleepingFragments[k].frags;
+        for (uint32_t j = 0; j < (uint32_t)s.size(); j++) {
+            hashSleepers.push_back({k, j});
+            hashX.push_back(s.px[j]); hashY.push_back(s.py[j]); hashZ.push_back(s.pz[j]); hashR.push_back(s.radius[j]);
+        }
+    }
+}
+
+static void collideFragments() {
+    auto t0 = std::chrono::high_resolution_clock::now();
+    FragmentStore& f = fragments;
+    int n = (int)f.size();
+    hashX.assign(f.px.begin(), f.px.end());
+    hashY.assign(f.py.begin(), f.py.end());
+    hashZ.assign(f.pz.begin(), f.pz.end());
+    hashR.assign(f.radius.begin(), f.radius.end());
+    gatherNearbySleepers(f);
+    uint32_t total = (uint32_t)hashX.size();
+    float maxR = 0.05f;
+    for (float r : hashR) maxR = std::max(maxR, r);
+    fragmentHash.build(hashX.data(), hashY.data(), hashZ.data(), total, maxR * 2.0f);
+
+    static std::vector<Vec3> dpos, dvel;
+    static std::vector<int> wakeHit;
+    dpos.assign(n, Vec3{0, 0, 0});
+    dvel.assign(n, Vec3{0, 0, 0});
+    wakeHit.assign(n, -1);
+    std::atomic<size_t> contacts{0};
+
+    parallelFor(n, PHYS_JOB_GRAIN, [&](int begin, int end) {
+        size_t local = 0;
+        for (int i = begin; i < end; i++) {
+            Vec3 pi = {hashX[i], hashY[i], hashZ[i]};
+            Vec3 vi = {f.vx[i], f.vy[i], f.vz[i]};
+            float ri = hashR[i], mi = ri * ri * ri;
+            Vec3 dp = {0, 0, 0}, dv = {0, 0, 0};
+            bool touched = false;
+            fragmentHash.query(pi.x, pi.y, pi.z, [&](uint32_t j) {
+                if ((int)j == i) return;
+                Vec3 d = pi - Vec3{hashX[j], hashY[j], hashZ[j]};
+                float reach = ri + hashR[j];
+                float dist2 = d.lengthSq();
+                if (dist2 >= reach * reach) return;
+                float dist = sqrtf(dist2);
+                Vec3 nrm = dist > 1e-6f ? d * (1.0f / dist) : Vec3{0, 1, 0};
+                bool sleeper = (int)j >= n;
+                float share = 1.0f;
+                Vec3 vj = {0, 0, 0};
+                if (!sleeper) {
+                    float mj = hashR[j] * hashR[j] * hashR[j];
+                    share = nrm.y > PHYS_SUPPORT_NORMAL ? 1.0f : nrm.y < -PHYS_SUPPORT_NORMAL ? 0.0f : mj / (mi + mj);
+                    vj = {f.vx[j], f.vy[j], f.vz[j]};
+                }
+                dp += nrm * ((reach - dist) * share * PHYS_CONTACT_RELAX);
+                Vec3 rel = vi - vj;
+                float vn = Vec3::dot(rel, nrm);
+                if (vn < 0) {
+                    dv += nrm * (-(1.0f + PHYS_BOUNCE_DAMPING) * vn * share);
+                    dv -= (rel - nrm * vn) * (PHYS_CONTACT_FRICTION * share);
+                    if (sleeper && -vn > PHYS_WAKE_IMPACT && wakeHit[i] < 0) wakeHit[i] = (int)j - n;
+                }
+                touched = true;
+                local++;
+            });
+            dpos[i] = dp;
+            dvel[i] = dv;
+            f.contact[i] = touched;
+        }
+        contacts += local;
+    });
+
+    for (int i = 0; i < n; i++) {
+        f.px[i] += dpos[i].x; f.py[i] += dpos[i].y; f.pz[i] += dpos[i].z;
+        f.vx[i] += dvel[i].x; f.vy[i] += dvel[i].y; f.vz[i] += dvel[i].z;
+        if (wakeHit[i] >= 0) pendingWakes.push_back(hashSleepers[wakeHit[i]]);
+    }
+    lastContactCount = contacts;
+    lastCollideMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+// Rows recorded during the step are still valid here: since then sleepers
+// have only been appended. Each bucket is woken from its highest row down, so
+// the swap-removal in wakeSleeper never moves a row still to be woken, and a
+// sleeper hit twice is woken once.
+static void applyPendingWakes() {
+    std::sort(pendingWakes.begin(), pendingWakes.end(), [](const SleeperRef& a, const SleeperRef& b) {
+        return a.key != b.key ? a.key < b.key : a.row > b.row;
+    });
+    pendingWakes.erase(std::unique(pendingWakes.begin(), pendingWakes.end(), [](const SleeperRef& a, const SleeperRef& b) {
+        return a.key == b.key && a.row == b.row;
+    }), pendingWakes.end());
+    for (size_t i = 0; i < pendingWakes.size();) {
+        uint64_t key = pendingWakes[i].key;
+        auto it = sleepingFragments.find(key);
+        for (; i < pendingWakes.size() && pendingWakes[i].key == key; i++)
+            if (it != sleepingFragments.end()) wakeSleeper(it->second, pendingWakes[i].row);
+        if (it != sleepingFragments.end() && it->second.frags.empty()) sleepingFragments.erase(it);
+    }
+    pendingWakes.clear();
+}
+
+// Bodies only read the block grid and write their own rows, so ranges run on
+// the job system in any order. Removal, sleeping and waking happen afterwards
+// on this thread, in index order, so the result does not depend on the thread
+// count.
 static void updateAllFragments(float dt) {
-    for (auto& fr : fragments) {
-        updateFragmentPhysics(fr, dt);
+    FragmentStore& f = fragments;
+    BodyArrays b = fragmentBodies(f);
+    physicsTime += dt;
+
+    parallelFor(b.count, PHYS_JOB_GRAIN, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) f.settlePose(i);
+        integrateBodies(b, begin, end, dt);
+        for (int i = begin; i < end; i++) settleBody(b, i, dt);
+    });
+    if (b.count > 0) collideFragments();
+
+    size_t keep = 0;
+    for (int i = 0; i < b.count; i++) {
+        bool alive = f.py[i] >= -50.0f;
+        if (!f.eternal[i]) {
+            f.life[i] += dt;
+            if (f.life[i] >= f.maxLife[i]) alive = false;
+        }
+        if (!alive) { releaseMesh(f.mesh[i]); continue; }
+        if (f.restTime[i] >= PHYS_SLEEP_DELAY) { putToSleep(f, i); continue; }
+        if (keep != (size_t)i) f.move(keep, i);
+        keep++;
+    }
+    f.resize(keep);
+    applyPendingWakes();
+    expireSleepers();
+}
+
+static void setFragmentsEternal(bool eternal) {
+    for (size_t i = 0; i < fragments.size(); i++) {
+        fragments.eternal[i] = eternal;
+        if (!eternal) { fragments.life[i] = 0; fragments.maxLife[i] = fragmentTimeout; }
+    }
+    sleepDeaths.clear();
+    for (auto& kv : sleepingFragments) {
+        SleepBucket& bucket = kv.second;
+        for (size_t j = 0; j < bucket.frags.size(); j++) {
+            bucket.frags.eternal[j] = eternal;
+            bucket.deathTime[j] = eternal ? HUGE_VAL : physicsTime + fragmentTimeout;
+            if (!eternal) { bucket.frags.life[j] = 0; bucket.frags.maxLife[j] = fragmentTimeout; }
+        }
+        if (!eternal && !bucket.frags.empty()) pushSleepDeath(physicsTime + fragmentTimeout, kv.first);
+    }
+}
+
+static void clearFragments() {
+    for (int id : fragments.mesh) releaseMesh(id);
+    fragments.clear();
+    for (auto& kv : sleepingFragments)
+        for (int id : kv.second.frags.mesh) releaseMesh(id);
+    sleepingFragments.clear();
+    sleepDeaths.clear();
+    sleepingCount = 0;
+}
+
+// `n` awake fragments spread over a flat patch far from the city so only the
+// ground plane and each other are in reach. They all share `mesh`.
+// benchFragmentCollision and the microbenchmarks both step this pile.
+static void spawnFragmentField(int n, uint32_t seed, int mesh = -1) {
+    std::mt19937 g(seed);
+    float side = sqrtf((float)n) * 0.6f;
+    std::uniform_real_distribution<float> px(0, side), py(0.5f, 6.0f), pv(-1.0f, 1.0f);
+    for (int i = 0; i < n; i++) {
+        Fragment fr = {};
+        fr.position = {-1000.0f + px(g), py(g), -1000.0f + px(g)};
+        fr.velocity = {pv(g), pv(g), pv(g)};
+        fr.rotSpeed = {pv(g), pv(g), pv(g)};
+        fr.scale = {1, 1, 1};
+        if (mesh >= 0) retainMesh(mesh);
+        fr.mesh = mesh;
+        fr.eternal = true;
+        spawnFragment(fr, 0.25f);
+    }
+}
+
+// F6 in the game and BENCH -collision: steps a synthetic pile of N fragments
+// (off to the side of the city, so only the ground plane and each other are
+// in play) for each N and writes the average step and collision times. The
+// live fragments are set aside and put back afterwards.
+static void benchFragmentCollision(const char* path) {
+    FILE* out = fopen(path, "w");
+    if (!out) return;
+    FragmentStore savedAwake;
+    std::swap(savedAwake, fragments);
+    std::unordered_map<uint64_t, SleepBucket> savedSleeping;
+    std::swap(savedSleeping, sleepingFragments);
+    std::vector<std::pair<double, uint64_t>> savedDeaths;
+    std::swap(savedDeaths, sleepDeaths);
+    size_t savedCount = sleepingCount;
+    sleepingCount = 0;
+
+    fprintf(out, "fragment collision benchmark, %d worker threads\n", jobWorkerCount());
+    fprintf(out, "%10s %12s %12s %12s %12s\n", "fragments", "step_ms", "collide_ms", "contacts", "ns/frag");
+    const int counts[] = {1000, 2500, 5000, 10000, 20000, 40000};
+    const int steps = 120;
+    for (int n : counts) {
+        spawnFragmentField(n, 1234);
+        double stepMs = 0, collideMs = 0;
+        size_t contacts = 0;
+        for (int s = 0; s < steps; s++) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            updateAllFragments(1.0f / 60.0f);
+            stepMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - t0).count();
+            collideMs += lastCollideMs;
+            contacts += lastContactCount;
+        }
+        stepMs /= steps;
+        fprintf(out, "%10d %12.3f %12.3f %12zu %12.1f\n", n, stepMs, collideMs / steps, contacts / steps, stepMs * 1e6 / n);
+        clearFragments();
     }
-    fragments.erase(
-        std::remove_if(fragments.begin(), fragments.end(),
-            [](const Fragment& f) { return !f.active; }),
-        fragments.end());
+    fclose(out);
+
+    std::swap(savedAwake, fragments);
+    std::swap(savedSleeping, sleepingFragments);
+    std::swap(savedDeaths, sleepDeaths);
+    sleepingCount = savedCount;
 }
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+// Free-list sub-allocator over an abstract [0, capacity) range. Units are
+// whatever the caller uses (vertices, indices); offsets never move, so a
+// range handed out stays valid until it is released.
+struct RangeAllocator {
+    uint32_t capacity = 0;
+    uint32_t used = 0;
+    std::map<uint32_t, uint32_t> freeList;
+
+    void reset(uint32_t cap) {
+        capacity = cap;
+        used = 0;
+        freeList.clear();
+        if (cap) freeList[0] = cap;
+    }
+
+    void addFree(uint32_t offset, uint32_t size) {
+        auto next = freeList.lower_bound(offset);
+        if (next != freeList.begin()) {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset) {
+                offset = prev->first;
+                size += prev->second;
+                freeList.erase(prev);
+            }
+        }
+        if (next != freeList.end() && offset + size == next->first) {
+            size += next->second;
+            freeList.erase(next);
+        }
+        freeList[offset] = size;
+    }
+
+    // First fit; returns false when no free block is large enough.
+    bool alloc(uint32_t size, uint32_t& offset) {
+        if (size == 0) { offset = 0; return true; }
+        for (auto it = freeList.begin(); it != freeList.end(); ++it) {
+            if (it->second < size) continue;
+            offset = it->first;
+            uint32_t rest = it->second - size;
+            freeList.erase(it);
+            if (rest) freeList[offset + size] = rest;
+            used += size;
+            return true;
+        }
+        return false;
+    }
+
+    void release(uint32_t offset, uint32_t size) {
+        if (size == 0) return;
+        used -= size;
+        addFree(offset, size);
+    }
+
+    void grow(uint32_t newCapacity) {
+        if (newCapacity <= capacity) return;
+        addFree(capacity, newCapacity - capacity);
+        capacity = newCapacity;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,17 @@
+#!/bin/sh
+# Headless builds: the replay benchmark, the kernel microbenchmarks and the
+# tests, no window or GPU needed. The microbenchmarks build against Google
+# Benchmark when it is installed and on the built-in runner otherwise. The
+# tests are built twice, for SSE2 and for AVX, so both widths of the SIMD
+# kernels are checked. Extra arguments go to the compiler (e.g. -march=native).
+cd "$(dirname "$0")"
+if printf '#include <benchmark/benchmark.h>\nint main() {}\n' |
+   g++ -x c++ - -lbenchmark -pthread -o /dev/null 2>/dev/null; then
+    MICROBENCH="-DUSE_GOOGLE_BENCHMARK MICROBENCH.cpp -lbenchmark"
+else
+    MICROBENCH="MICROBENCH.cpp"
+fi
+g++ -std=c++17 -O2 -pthread "$@" -o bench BENCH.cpp &&
+g++ -std=c++17 -O2 -pthread "$@" -o microbench $MICROBENCH &&
+g++ -std=c++17 -O2 -pthread "$@" -o tests TESTS.cpp &&
+g++ -std=c++17 -O2 -pthread -mavx "$@" -o tests_avx TESTS.cpp && echo BUILD OK
@@ -0,0 +1,220 @@
+#pragma once
+
+static const float CHUNK_RADIUS = CHUNK_SIZE * 0.8661f;
+
+// Cached, eye-independent mesh of one ChunkSection. Vertex colours are the
+// face-shaded albedo; lighting and fog are evaluated in the shaders. The GPU copy lives
+// in a persistent pool range (in vertex/index units) that is refreshed only
+// when the section is re-meshed. The bounds are those of the vertices, which
+// for a half-empty section are much tighter than the section itself. The
+// occluders are the section's largest solid slabs (see findChunkOccluders).
+struct ChunkMesh {
+    std::vector<Vertex> verts;
+    std::vector<uint32_t> inds;
+    Vec3 boundsMin = {0, 0, 0}, boundsMax = {0, 0, 0};
+    std::vector<OccluderQuad> occluders;
+    uint32_t gpuVtxOffset = 0, gpuVtxCount = 0;
+    uint32_t gpuIdxOffset = 0, gpuIdxCount = 0;
+    bool gpuStale = true;
+};
+
+enum ChunkMeshMode { MESH_CULLED = 0, MESH_GREEDY = 1 };
+
+static std::unordered_map<uint64_t, ChunkMesh> chunkMeshes;
+static int chunkMeshMode = MESH_GREEDY;
+
+// GPU pool ranges of meshes whose sections left the world. The renderer frees
+// them on its next upload; headless runs just drop them.
+struct ReleasedChunkRange {
+    uint32_t vtxOffset, vtxCount;
+    uint32_t idxOffset, idxCount;
+};
+
+static std::vector<ReleasedChunkRange> releasedChunkRanges;
+
+static Vec3 chunkCenter(const ChunkSection& c) {
+    float h = CHUNK_SIZE * 0.5f - 0.5f;
+    return {
+        (float)(c.cx * CHUNK_SIZE) + h,
+        (float)(c.cy * CHUNK_SIZE) + h,
+        (float)(c.cz * CHUNK_SIZE) + h
+    };
+}
+
+static const int OCCLUDER_MIN_AREA = 16;     // blocks
+static const int OCCLUDERS_PER_CHUNK = 8;
+static const int OCCLUSION_MAX_QUADS = 384;  // per frame, nearest chunks first
+static const float OCCLUDER_DISTANCE = 64.0f;
+
+// Finds solid rectangles of blocks in each axis-aligned slice of the section
+// (greedy, like the mesher, but ignoring colour) and keeps the largest as
+// quads through the block centres. Anything a quad covers on screen is behind
+// solid blocks, so it is a safe occluder: a building wall, a stretch of ground.
+static void findChunkOccluders(const ChunkSection& c, std::vector<OccluderQuad>& out) {
+    out.clear();
+    if (c.count < OCCLUDER_MIN_AREA) return;
+    struct Rect { int area, axis, slice, u, v, w, h; };
+    std::vector<Rect> rects;
+    for (int axis = 0; axis < 3; axis++) {
+        for (int slice = 0; slice < CHUNK_SIZE; slice++) {
+            // rows[v] bit u: cell (u, v) of this slice is solid.
+            uint32_t rows[CHUNK_SIZE];
+            for (int v = 0; v < CHUNK_SIZE; v++) {
+                rows[v] = 0;
+                for (int u = 0; u < CHUNK_SIZE; u++) {
+                    int lx = axis == 0 ? slice : u;
+                    int ly = axis == 1 ? slice : v;
+                    int lz = axis == 0 ? u : (axis == 1 ? v : slice);
+                    if (c.cells[ChunkSection::cellIndex(lx, ly, lz)]) rows[v] |= 1u << u;
+                }
+            }
+            for (int v = 0; v < CHUNK_SIZE; v++) {
+                while (rows[v]) {
+                    int u = 0;
+                    while (!(rows[v] >> u & 1)) u++;
+                    int w = 0;
+                    while (u + w < CHUNK_SIZE && (rows[v] >> (u + w) & 1)) w++;
+                    uint32_t span = ((1u << w) - 1) << u;
+                    int h = 1;
+                    while (v + h < CHUNK_SIZE && (rows[v + h] & span) == span) h++;
+                    for (int k = 0; k < h; k++) rows[v + k] &= ~span;
+                    if (w * h >= OCCLUDER_MIN_AREA) rects.push_back({w * h, axis, slice, u, v, w, h});
+                }
+            }
+        }
+    }
+    size_t keep = std::min(rects.size(), (size_t)OCCLUDERS_PER_CHUNK);
+    std::partial_sort(rects.begin(), rects.begin() + keep, rects.end(), [](const Rect& a, const Rect& b) { return a.area > b.area; });
+    float bx = (float)(c.cx * CHUNK_SIZE), by = (float)(c.cy * CHUNK_SIZE), bz = (float)(c.cz * CHUNK_SIZE);
+    for (size_t i = 0; i < keep; i++) {
+        const Rect& r = rects[i];
+        float s = (float)r.slice, u0 = r.u - 0.5f, u1 = r.u + r.w - 0.5f, v0 = r.v - 0.5f, v1 = r.v + r.h - 0.5f;
+        OccluderQuad q;
+        float us[4] = {u0, u1, u1, u0}, vs[4] = {v0, v0, v1, v1};
+        for (int k = 0; k < 4; k++) {
+            if (r.axis == 0) q.corner[k] = {bx + s, by + vs[k], bz + us[k]};
+            else if (r.axis == 1) q.corner[k] = {bx + us[k], by + s, bz + vs[k]};
+            else q.corner[k] = {bx + us[k], by + vs[k], bz + s};
+        }
+        out.push_back(q);
+    }
+}
+
+static void meshChunk(const ChunkSection& c, ChunkMesh& m) {
+    m.verts.clear();
+    m.inds.clear();
+    if (chunkMeshMode == MESH_GREEDY) {
+        genChunkGreedy(c, m.verts, m.inds);
+    } else {
+        for (int idx : c.blocks) {
+            if (idx < 0 || !worldBlocks[idx].active) continue;
+            const Block& bl = worldBlocks[idx];
+            genCubeOptimized(bl.position, bl.color, BLOCK_SIZE, m.verts, m.inds);
+        }
+    }
+    Vec3 mn = {1e30f, 1e30f, 1e30f}, mx = {-1e30f, -1e30f, -1e30f};
+    for (const Vertex& v : m.verts) {
+        mn = {std::min(mn.x, v.pos.x), std::min(mn.y, v.pos.y), std::min(mn.z, v.pos.z)};
+        mx = {std::max(mx.x, v.pos.x), std::max(mx.y, v.pos.y), std::max(mx.z, v.pos.z)};
+    }
+    if (m.verts.empty()) mn = mx = chunkCenter(c);
+    m.boundsMin = mn;
+    m.boundsMax = mx;
+    findChunkOccluders(c, m.occluders);
+}
+
+// Re-meshes only sections whose dirty bit is set. Returns how many were rebuilt.
+static int updateChunkMeshes() {
+    if (!blockGrid) return 0;
+    int rebuilt = 0;
+    for (auto& kv : blockGrid->chunks) {
+        ChunkSection* c = kv.second;
+        if (!c->dirty) continue;
+        ChunkMesh& m = chunkMeshes[kv.first];
+        meshChunk(*c, m);
+        m.gpuStale = true;
+        c->dirty = false;
+        rebuilt++;
+    }
+    return rebuilt;
+}
+
+// Switching modes re-meshes every section on the next update.
+static void setChunkMeshMode(int mode) {
+    chunkMeshMode = mode;
+    if (!blockGrid) return;
+    for (auto& kv : blockGrid->chunks) kv.second->dirty = true;
+}
+
+static size_t chunkTriangleCount() {
+    size_t tris = 0;
+    if (!blockGrid) return 0;
+    for (auto& kv : blockGrid->chunks) {
+        auto it = chunkMeshes.find(kv.first);
+        if (it != chunkMeshes.end()) tris += it->second.inds.size() / 3;
+    }
+    return tris;
+}
+
+static void dropChunkMesh(uint64_t key) {
+    auto it = chunkMeshes.find(key);
+    if (it == chunkMeshes.end()) return;
+    const ChunkMesh& m = it->second;
+    if (m.gpuVtxCount || m.gpuIdxCount)
+        releasedChunkRanges.push_back({m.gpuVtxOffset, m.gpuVtxCount, m.gpuIdxOffset, m.gpuIdxCount});
+    chunkMeshes.erase(it);
+}
+
+static void clearChunkMeshes() {
+    chunkMeshes.clear();
+}
+
+// Rasterises the occluders of chunks near `eye` that pass the frustum,
+// nearest first and up to OCCLUSION_MAX_QUADS, and builds the depth pyramid.
+// Call ob.begin() with the frame's view-projection first.
+static void drawChunkOccluders(OcclusionBuffer& ob, Vec3 eye, const Frustum& frustum) {
+    if (blockGrid) {
+        struct Near { float d; const ChunkMesh* m; };
+        ArenaScope scratch(frameArena);
+        ArenaVector<Near> near{ArenaAllocator<Near>(frameArena)};
+        float reach = OCCLUDER_DISTANCE + CHUNK_RADIUS;
+        for (auto& kv : blockGrid->chunks) {
+            float d = (chunkCenter(*kv.second) - eye).lengthSq();
+            if (d > reach * reach) continue;
+            auto it = chunkMeshes.find(kv.first);
+            if (it == chunkMeshes.end() || it->second.occluders.empty()) continue;
+            if (!frustum.boxVisible(it->second.boundsMin, it->second.boundsMax)) continue;
+            near.push_back({d, &it->second});
+        }
+        std::sort(near.begin(), near.end(), [](const Near& a, const Near& b) { return a.d < b.d; });
+        int budget = OCCLUSION_MAX_QUADS;
+        for (const Near& n : near) {
+            for (const OccluderQuad& q : n.m->occluders) if (budget-- > 0) ob.drawQuad(q);
+            if (budget <= 0) break;
+        }
+    }
+    ob.buildHiZ();
+    cullStats.occluderQuads += ob.quadsDrawn;
+}
+
+// Collects the cached meshes of non-empty sections within renderDist of eye
+// and, when given, inside the frustum and not hidden in the occlusion buffer.
+static void collectVisibleChunks(Vec3 eye, float renderDist, std::vector<const ChunkMesh*>& out, const Frustum* frustum = nullptr,
+                                 const OcclusionBuffer* occlusion = nullptr) {
+    out.clear();
+    if (!blockGrid) return;
+    float maxDist = renderDist + CHUNK_RADIUS;
+    for (auto& kv : blockGrid->chunks) {
+        const ChunkSection* c = kv.second;
+        if (c->count == 0) continue;
+        if ((chunkCenter(*c) - eye).lengthSq() > maxDist * maxDist) continue;
+        auto it = chunkMeshes.find(kv.first);
+        if (it == chunkMeshes.end() || it->second.inds.empty()) continue;
+        if (frustum) {
+            cullStats.chunksTested++;
+            if (!frustum->boxVisible(it->second.boundsMin, it->second.boundsMax)) { cullStats.chunksCulled++; continue; }
+        }
+        if (occlusion && !occlusion->boxVisible(it->second.boundsMin, it->second.boundsMax)) { cullStats.chunksOccluded++; continue; }
+        out.push_back(&it->second);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+// View frustum as six inward-facing planes, taken straight from a
+// view-projection matrix (Gribb/Hartmann) with Vulkan's 0..w depth range.
+// Used to keep chunks, fragments and particles that cannot reach the screen
+// out of the draw lists.
+struct Frustum {
+    float nx[6], ny[6], nz[6], d[6];
+
+    static Frustum fromMatrix(const Mat4& m) {
+        // Row r of the matrix is m[r], m[4 + r], m[8 + r], m[12 + r].
+        auto row = [&](int r, float s, float out[4]) {
+            out[0] = m.m[3] + s * m.m[r];
+            out[1] = m.m[7] + s * m.m[4 + r];
+            out[2] = m.m[11] + s * m.m[8 + r];
+            out[3] = m.m[15] + s * m.m[12 + r];
+        };
+        float p[6][4];
+        row(0, 1, p[0]);  // left:   w + x >= 0
+        row(0, -1, p[1]); // right:  w - x >= 0
+        row(1, 1, p[2]);  // bottom: w + y >= 0
+        row(1, -1, p[3]); // top:    w - y >= 0
+        row(2, -1, p[4]); // far:    w - z >= 0
+        p[5][0] = m.m[2]; p[5][1] = m.m[6]; p[5][2] = m.m[10]; p[5][3] = m.m[14]; // near: z >= 0
+        Frustum f;
+        for (int i = 0; i < 6; i++) {
+            float len = sqrtf(p[i][0] * p[i][0] + p[i][1] * p[i][1] + p[i][2] * p[i][2]);
+            float inv = len > 0 ? 1.0f / len : 0.0f;
+            f.nx[i] = p[i][0] * inv;
+            f.ny[i] = p[i][1] * inv;
+            f.nz[i] = p[i][2] * inv;
+            f.d[i] = p[i][3] * inv;
+        }
+        return f;
+    }
+
+    bool sphereVisible(Vec3 c, float r) const {
+        for (int i = 0; i < 6; i++)
+            if (nx[i] * c.x + ny[i] * c.y + nz[i] * c.z + d[i] < -r) return false;
+        return true;
+    }
+
+    // Tests the box corner furthest along each plane normal; if even that one
+    // is outside a plane, the whole box is.
+    bool boxVisible(Vec3 mn, Vec3 mx) const {
+        for (int i = 0; i < 6; i++) {
+            float x = nx[i] >= 0 ? mx.x : mn.x;
+            float y = ny[i] >= 0 ? mx.y : mn.y;
+            float z = nz[i] >= 0 ? mx.z : mn.z;
+            if (nx[i] * x + ny[i] * y + nz[i] * z + d[i] < 0) return false;
+        }
+        return true;
+    }
+};
+
+// What the last frame's culling tested and rejected: *Culled by the frustum,
+// *Occluded by the occlusion buffer (of those the frustum kept; particles are
+// too small to be worth the test). Whoever builds the frame resets it first
+// (the renderer's rebuild, the replay bench).
+struct CullStats {
+    uint32_t chunksTested = 0, chunksCulled = 0, chunksOccluded = 0;
+    uint32_t fragmentsTested = 0, fragmentsCulled = 0, fragmentsOccluded = 0;
+    uint32_t particlesTested = 0, particlesCulled = 0;
+    uint32_t occluderQuads = 0;
+};
+
+static CullStats cullStats;
\ No newline at end of file
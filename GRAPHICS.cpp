@@ -25,32 +25,21 @@ static void initLighting() {
     cityLight.fogEnd = 120.0f;
 }
 
-static Vec3 computeVertexLighting(Vec3 pos, Vec3 normal, Vec3 baseColor) {
-    float ndotl = Vec3::dot(normal, Vec3{0,0,0} - cityLight.sunDir);
-    if (ndotl < 0) ndotl = 0;
-    Vec3 diffuse = cityLight.sunColor * (ndotl * cityLight.sunIntensity);
-    Vec3 ambient = cityLight.ambientColor * cityLight.ambientIntensity;
-    float upFactor = normal.y * 0.5f + 0.5f;
-    Vec3 sky = cityLight.fogColor * (upFactor * 0.12f);
-    return {
-        clampf(baseColor.x * (diffuse.x + ambient.x + sky.x), 0, 1),
-        clampf(baseColor.y * (diffuse.y + ambient.y + sky.y), 0, 1),
-        clampf(baseColor.z * (diffuse.z + ambient.z + sky.z), 0, 1)
-    };
-}
-
-static Vec3 applyFog(Vec3 color, float dist) {
-    float f = clampf((dist - cityLight.fogStart) / (cityLight.fogEnd - cityLight.fogStart), 0, 1);
-    f = f * f;
-    return {
-        color.x + (cityLight.fogColor.x - color.x) * f,
-        color.y + (cityLight.fogColor.y - color.y) * f,
-        color.z + (cityLight.fogColor.z - color.z) * f
-    };
-}
+// std140 mirror of the LightBlock uniform in SHADERS/fragment.glsl.
+struct LightUniforms {
+    float sunDir[4];        // xyz direction, w intensity
+    float sunColor[4];      // rgb, w ambient intensity
+    float ambientColor[4];
+    float fogColor[4];      // rgb, w fog start
+    float fogEnd[4];        // x fog end
+};
 
-static Vec3 computeFullLighting(Vec3 pos, Vec3 normal, Vec3 baseColor, Vec3 eyePos) {
-    Vec3 lit = computeVertexLighting(pos, normal, baseColor);
-    float dist = (pos - eyePos).length();
-    return applyFog(lit, dist);
+static LightUniforms packLightUniforms(const LightData& l) {
+    LightUniforms u = {};
+    u.sunDir[0] = l.sunDir.x; u.sunDir[1] = l.sunDir.y; u.sunDir[2] = l.sunDir.z; u.sunDir[3] = l.sunIntensity;
+    u.sunColor[0] = l.sunColor.x; u.sunColor[1] = l.sunColor.y; u.sunColor[2] = l.sunColor.z; u.sunColor[3] = l.ambientIntensity;
+    u.ambientColor[0] = l.ambientColor.x; u.ambientColor[1] = l.ambientColor.y; u.ambientColor[2] = l.ambientColor.z;
+    u.fogColor[0] = l.fogColor.x; u.fogColor[1] = l.fogColor.y; u.fogColor[2] = l.fogColor.z; u.fogColor[3] = l.fogStart;
+    u.fogEnd[0] = l.fogEnd;
+    return u;
 }
\ No newline at end of file
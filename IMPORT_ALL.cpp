@@ -9,23 +9,11 @@
 #undef near
 #undef far
 #include <vulkan/vulkan.h>
+#include <cstdarg>
 
-#include <vector>
-#include <cmath>
-#include <cstdlib>
-#include <cstring>
-#include <cstdio>
-#include <algorithm>
-#include <random>
-#include <chrono>
-#include <fstream>
-#include <string>
-
-#include "TYPES.cpp"
+#include "SIM_CORE.cpp"
+#include "PLATFORM.cpp"
+#include "RENDER_STATE.cpp"
 #include "SOUNDMANAGER.cpp"
 #include "GRAPHICS.cpp"
-#include "ALLOPTIMIZER.cpp"
-#include "BLOCK_PHYSICS.cpp"
-#include "BLOCK_FRACTURE.cpp"
-#include "BLOCK_PARTICLES.cpp"
-#include "BLOCK_DELETE.cpp"
\ No newline at end of file
+#include "BUFFER_ALLOCATOR.cpp"
\ No newline at end of file
@@ -0,0 +1,133 @@
+#pragma once
+
+// Small work-stealing job system. Every worker (and the main thread, slot 0)
+// owns a deque: it pushes and pops at the back, idle workers steal from the
+// front of the others. Waiting on a counter runs jobs instead of blocking, so
+// nested parallelFor calls cannot deadlock.
+
+struct JobCounter {
+    std::atomic<int> pending{0};
+};
+
+struct Job {
+    std::function<void()> fn;
+    JobCounter* counter;
+};
+
+struct JobQueue {
+    std::mutex lock;
+    std::deque<Job> jobs;
+};
+
+static std::vector<std::thread> jobThreads;
+static std::vector<JobQueue*> jobQueues;
+static std::atomic<bool> jobsRunning{false};
+static std::atomic<int> jobsQueued{0};
+static std::mutex jobSleepLock;
+static std::condition_variable jobWake;
+static thread_local int jobSlot = 0;
+
+static int jobWorkerCount() {
+    return (int)jobThreads.size();
+}
+
+static bool popJob(int slot, Job& out) {
+    JobQueue* own = jobQueues[slot];
+    {
+        std::lock_guard<std::mutex> g(own->lock);
+        if (!own->jobs.empty()) {
+            out = std::move(own->jobs.back());
+            own->jobs.pop_back();
+            jobsQueued--;
+            return true;
+        }
+    }
+    int n = (int)jobQueues.size();
+    for (int k = 1; k < n; k++) {
+        JobQueue* victim = jobQueues[(slot + k) % n];
+        std::lock_guard<std::mutex> g(victim->lock);
+        if (!victim->jobs.empty()) {
+            out = std::move(victim->jobs.front());
+            victim->jobs.pop_front();
+            jobsQueued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool runOneJob() {
+    Job job;
+    if (!popJob(jobSlot, job)) return false;
+    job.fn();
+    job.counter->pending--;
+    return true;
+}
+
+static void jobWorkerMain(int slot) {
+    jobSlot = slot;
+    while (jobsRunning) {
+        if (runOneJob()) continue;
+        std::unique_lock<std::mutex> g(jobSleepLock);
+        jobWake.wait(g, [] { return jobsQueued > 0 || !jobsRunning; });
+    }
+}
+
+// threads < 0 picks one worker per spare hardware thread; 0 runs every job
+// inline on the caller.
+static void initJobs(int threads = -1) {
+    if (threads < 0) threads = std::max(0, (int)std::thread::hardware_concurrency() - 1);
+    jobQueues.push_back(new JobQueue());
+    jobsRunning = true;
+    for (int i = 0; i < threads; i++) {
+        jobQueues.push_back(new JobQueue());
+        jobThreads.emplace_back(jobWorkerMain, i + 1);
+    }
+}
+
+static void shutdownJobs() {
+    {
+        std::lock_guard<std::mutex> g(jobSleepLock);
+        jobsRunning = false;
+    }
+    jobWake.notify_all();
+    for (auto& t : jobThreads) t.join();
+    jobThreads.clear();
+    for (JobQueue* q : jobQueues) delete q;
+    jobQueues.clear();
+}
+
+static void submitJob(std::function<void()> fn, JobCounter& counter) {
+    if (jobThreads.empty()) { fn(); return; }
+    counter.pending++;
+    {
+        std::lock_guard<std::mutex> g(jobQueues[jobSlot]->lock);
+        jobQueues[jobSlot]->jobs.push_back({std::move(fn), &counter});
+    }
+    {
+        std::lock_guard<std::mutex> g(jobSleepLock);
+        jobsQueued++;
+    }
+    jobWake.notify_one();
+}
+
+static void waitJobs(JobCounter& counter) {
+    while (counter.pending > 0) {
+        if (!runOneJob()) std::this_thread::yield();
+    }
+}
+
+// Splits [0, count) into ranges of `grain` and runs fn(begin, end) on them in
+// parallel. Ranges never overlap, so fn may write to its own elements freely.
+template <typename F>
+static void parallelFor(int count, int grain, F fn) {
+    if (count <= 0) return;
+    if (jobThreads.empty() || count <= grain) { fn(0, count); return; }
+    JobCounter counter;
+    for (int begin = grain; begin < count; begin += grain) {
+        int end = std::min(count, begin + grain);
+        submitJob([&fn, begin, end] { fn(begin, end); }, counter);
+    }
+    fn(0, grain);
+    waitJobs(counter);
+}
\ No newline at end of file
@@ -11,18 +11,6 @@ static std::vector<uint32_t> loadSPV(const char* path) {
     f.seekg(0); f.read((char*)buf.data(),sz); return buf;
 }
 
-static Vec3 getCamForward() {
-    return {cosf(camPitch)*sinf(camYaw),-sinf(camPitch),cosf(camPitch)*cosf(camYaw)};
-}
-
-static Vec3 getCamRight() {
-    Vec3 fwd=getCamForward();
-    Vec3 up={0,1,0};
-    return Vec3::cross(fwd,up).normalized();
-}
-
-static Vec3 getEyePos() { return {playerPos.x,playerPos.y+PLAYER_EYE,playerPos.z}; }
-
 static void genCube(Vec3 pos, Vec3 col, float size, std::vector<Vertex>& V, std::vector<uint32_t>& I) {
     float h=size*0.5f;
     Vec3 c[8]={
@@ -103,110 +91,17 @@ static void breakBlock(Block& bl) {
         fr.color = bl.color;
         float s = fs * sd(rng);
         fr.scale = {s, s * sd(rng), s * sd(rng)};
-        genFragShape({0, 0, 0}, bl.color, fs, fr.vertices, fr.indices);
+        std::vector<Vertex> V; std::vector<uint32_t> I;
+        genFragShape({0, 0, 0}, bl.color, fs, V, I);
+        fr.mesh = createMesh(std::move(V), std::move(I));
         fr.lifetime = 0;
         fr.maxLifetime = fragmentTimeout;
         fr.eternal = fragmentsEternal;
         fr.active = true;
-        fragments.push_back(fr);
+        spawnFragment(fr);
     }
 }
 
-static void addBlock(Vec3 pos, Vec3 col, int type=0) {
-    Block b; b.position=pos; b.color=col; b.active=true; b.type=type;
-    worldBlocks.push_back(b);
-}
-
-static void generateStreet(int startX, int startZ, int length, int dir, int width) {
-    Vec3 asphalt={0.15f,0.15f,0.17f};
-    Vec3 sidewalk={0.45f,0.43f,0.40f};
-    Vec3 curb={0.35f,0.33f,0.30f};
-    Vec3 yellowLine={0.7f,0.65f,0.1f};
-    for(int i=0;i<length;i++) {
-        for(int w=-width;w<=width;w++) {
-            int bx=startX, bz=startZ;
-            if(dir==0) { bx+=i; bz+=w; } else { bz+=i; bx+=w; }
-            Vec3 col=asphalt;
-            if(abs(w)==width) col=curb;
-            else if(abs(w)==width-1) col=sidewalk;
-            else if(w==0 && (i%4<2)) col=yellowLine;
-            if(abs(w)>=width-1) {
-                addBlock({(float)bx,0,(float)bz},col,1);
-                addBlock({(float)bx,1,(float)bz},sidewalk,1);
-            } else {
-                addBlock({(float)bx,0,(float)bz},col,1);
-            }
-        }
-    }
-}
-
-static void generateBuilding(int bx, int bz, int w, int d, int h, Vec3 wallCol, Vec3 winCol, bool antenna) {
-    Vec3 frame={0.25f,0.22f,0.20f};
-    Vec3 roof={0.20f,0.18f,0.16f};
-    Vec3 trim={0.3f,0.28f,0.25f};
-    for(int x=0;x<w;x++) for(int z=0;z<d;z++) for(int y=2;y<h+2;y++) {
-        bool isEdge=(x==0||x==w-1||z==0||z==d-1);
-        bool isCorner=(x==0||x==w-1)&&(z==0||z==d-1);
-        bool isTop=(y==h+1);
-        if(!isEdge&&!isTop) continue;
-        Vec3 col=wallCol;
-        if(isCorner) col=frame;
-        else if(isTop) col=roof;
-        else if(isEdge&&!isCorner&&y>2) {
-            bool isWindowRow=(y-2)%3!=0;
-            bool isWindowCol;
-            if(x==0||x==w-1) isWindowCol=(z>0&&z<d-1&&(z%2==1));
-            else isWindowCol=(x>0&&x<w-1&&(x%2==1));
-            if(isWindowRow&&isWindowCol) {
-                std::uniform_real_distribution<float> lit(0.0f,1.0f);
-                if(lit(rng)>0.4f) { float bright=0.6f+lit(rng)*0.4f; col={winCol.x*bright,winCol.y*bright,winCol.z*bright}; }
-                else col={0.08f,0.1f,0.12f};
-            } else if((y-2)%3==0) col=trim;
-        }
-        addBlock({(float)(bx+x),(float)y,(float)(bz+z)},col,2);
-    }
-    if(antenna) {
-        int ax=bx+w/2, az=bz+d/2;
-        for(int ay=h+2;ay<h+7;ay++) addBlock({(float)ax,(float)ay,(float)az},{0.3f,0.3f,0.3f},3);
-        addBlock({(float)ax,(float)(h+7),(float)az},{0.8f,0.1f,0.1f},3);
-    }
-}
-
-static void generateCity17() {
-    worldBlocks.clear();
-
-    Vec3 ground={0.2f,0.22f,0.18f};
-    for(int x=-40;x<56;x++) for(int z=-40;z<56;z++) addBlock({(float)x,-1,(float)z},ground,0);
-
-    generateStreet(-40,6,96,0,4);
-    generateStreet(-40,22,96,0,4);
-    generateStreet(-40,38,96,0,4);
-    generateStreet(6,-40,96,1,4);
-    generateStreet(22,-40,96,1,4);
-    generateStreet(38,-40,96,1,4);
-
-    Vec3 walls[]={{0.42f,0.38f,0.35f},{0.35f,0.32f,0.30f},{0.50f,0.45f,0.40f},{0.38f,0.35f,0.33f},{0.30f,0.28f,0.25f},{0.45f,0.40f,0.38f}};
-    Vec3 wins[]={{0.7f,0.65f,0.3f},{0.3f,0.5f,0.7f},{0.8f,0.7f,0.4f},{0.6f,0.7f,0.8f},{0.9f,0.8f,0.5f}};
-    std::uniform_int_distribution<int> hd(8,25),wd(4,8),ci(0,5),wi(0,4),ant(0,3);
-    struct Lot { int x,z,w,d; };
-    std::vector<Lot> lots;
-    int streetPositions[]={6,22,38}; int streetWidth=9;
-    for(int sx=0;sx<4;sx++) for(int sz=0;sz<4;sz++) {
-        int x0=(sx==0)?-40:(streetPositions[sx-1]+streetWidth/2+1);
-        int x1=(sx==3)?56:(streetPositions[sx]-streetWidth/2-1);
-        int z0=(sz==0)?-40:(streetPositions[sz-1]+streetWidth/2+1);
-        int z1=(sz==3)?56:(streetPositions[sz]-streetWidth/2-1);
-        if(x1-x0<6||z1-z0<6) continue;
-        int bw=std::min(wd(rng)+2,x1-x0-2);
-        int bd=std::min(wd(rng)+2,z1-z0-2);
-        lots.push_back({x0+1,z0+1,bw,bd});
-        if(x1-x0>14) { int bw2=std::min(wd(rng)+2,x1-x0-bw-4); if(bw2>=4) lots.push_back({x0+1+bw+2,z0+1,bw2,bd}); }
-    }
-    for(auto& lot:lots) { int h=hd(rng); generateBuilding(lot.x,lot.z,lot.w,lot.d,h,walls[ci(rng)%6],wins[wi(rng)%5],ant(rng)==0); }
-    generateBuilding(12,12,10,10,35,{0.30f,0.32f,0.35f},{0.5f,0.6f,0.9f},true);
-    playerPos={8.0f,3.0f,8.0f};
-}
-
 static bool rayBlockIntersect(Vec3 ro, Vec3 rd, Vec3 bpos, float& t) {
     float h=0.5f;
     Vec3 mn={bpos.x-h,bpos.y-h,bpos.z-h}, mx={bpos.x+h,bpos.y+h,bpos.z+h};
@@ -218,69 +113,6 @@ static bool rayBlockIntersect(Vec3 ro, Vec3 rd, Vec3 bpos, float& t) {
     t=tmin>0?tmin:tmax; return t>0;
 }
 
-static void findTarget() {
-    Vec3 eye = getEyePos(), dir = getCamForward();
-    float bestT = REACH_DIST + 1;
-    hasTarget = false;
-    targetBlockIdx = -1;
-    if (!blockGrid) return;
-    float step = 0.15f;
-    for (float t = 0; t < REACH_DIST; t += step) {
-        Vec3 p = eye + dir * t;
-        int cx = (int)floorf(p.x + 0.5f);
-        int cy = (int)floorf(p.y + 0.5f);
-        int cz = (int)floorf(p.z + 0.5f);
-        for (int dx = -1; dx <= 1; dx++) {
-            for (int dy = -1; dy <= 1; dy++) {
-                for (int dz = -1; dz <= 1; dz++) {
-                    int idx = blockGrid->get(cx+dx, cy+dy, cz+dz);
-                    if (idx < 0 || !worldBlocks[idx].active) continue;
-                    Vec3 bpos = worldBlocks[idx].position;
-                    float h = 0.5f;
-                    Vec3 mn = {bpos.x-h, bpos.y-h, bpos.z-h};
-                    Vec3 mx = {bpos.x+h, bpos.y+h, bpos.z+h};
-                    float tmin = -1e30f, tmax = 1e30f;
-                    bool hit = true;
-                    if (fabsf(dir.x) > 1e-8f) {
-                        float ta = (mn.x-eye.x)/dir.x;
-                        float tb = (mx.x-eye.x)/dir.x;
-                        if (ta > tb) { float tmp=ta; ta=tb; tb=tmp; }
-                        tmin = std::max(tmin, ta);
-                        tmax = std::min(tmax, tb);
-                    } else if (eye.x < mn.x || eye.x > mx.x) hit = false;
-                    if (hit) {
-                        if (fabsf(dir.y) > 1e-8f) {
-                            float ta = (mn.y-eye.y)/dir.y;
-                            float tb = (mx.y-eye.y)/dir.y;
-                            if (ta > tb) { float tmp=ta; ta=tb; tb=tmp; }
-                            tmin = std::max(tmin, ta);
-                            tmax = std::min(tmax, tb);
-                        } else if (eye.y < mn.y || eye.y > mx.y) hit = false;
-                    }
-                    if (hit) {
-                        if (fabsf(dir.z) > 1e-8f) {
-                            float ta = (mn.z-eye.z)/dir.z;
-                            float tb = (mx.z-eye.z)/dir.z;
-                            if (ta > tb) { float tmp=ta; ta=tb; tb=tmp; }
-                            tmin = std::max(tmin, ta);
-                            tmax = std::min(tmax, tb);
-                        } else if (eye.z < mn.z || eye.z > mx.z) hit = false;
-                    }
-                    if (hit && tmin <= tmax && tmax > 0) {
-                        float ht = tmin > 0 ? tmin : tmax;
-                        if (ht > 0 && ht < bestT && ht <= REACH_DIST) {
-                            bestT = ht;
-                            targetBlockIdx = idx;
-                            hasTarget = true;
-                        }
-                    }
-                }
-            }
-        }
-        if (hasTarget) break;
-    }
-}
-
 static bool collidesPlayerAABB(Vec3 pos) {
     float r=PLAYER_RADIUS, pMinY=pos.y, pMaxY=pos.y+PLAYER_HEIGHT;
     for(auto& bl:worldBlocks) {
@@ -308,6 +140,104 @@ static void destroyBuf(VkBuffer& buf, VkDeviceMemory& mem) {
     if(buf!=VK_NULL_HANDLE) { vkDestroyBuffer(dev,buf,nullptr); vkFreeMemory(dev,mem,nullptr); buf=VK_NULL_HANDLE; }
 }
 
+static const VkMemoryPropertyFlags HOST_MEM=VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+// Long-lived, persistently mapped buffer carved up by a RangeAllocator.
+// Offsets/counts are in elements of `stride` bytes.
+struct GpuPool {
+    VkBuffer buf=VK_NULL_HANDLE; VkDeviceMemory mem=VK_NULL_HANDLE; char* mapped=nullptr;
+    VkBufferUsageFlags usage=0; uint32_t stride=0;
+    RangeAllocator ranges;
+};
+
+static const int MAX_FRAMES_IN_FLIGHT=3;
+static int framesInFlight=2;
+
+// Per-frame GPU state. Pool ranges and buffers released while recording a frame
+// are parked here and only really freed once this slot's fence has signalled.
+struct PendingFree { RangeAllocator* ranges; uint32_t offset, count; };
+struct FrameData {
+    VkCommandBuffer cmd; VkSemaphore imgSem, renSem; VkFence fence;
+    std::vector<PendingFree> frees;
+    std::vector<std::pair<VkBuffer,VkDeviceMemory>> garbage;
+};
+
+// Dynamic geometry ring: one buffer cut into framesInFlight slices, each slice
+// holding that frame's vertices, then its indices, then its fragment instances.
+struct DynamicRing {
+    VkBuffer buf=VK_NULL_HANDLE; VkDeviceMemory mem=VK_NULL_HANDLE; char* mapped=nullptr;
+    uint32_t sliceVerts=0, sliceInds=0, sliceInsts=0;
+    VkDeviceSize indsOffset() const { return (VkDeviceSize)sliceVerts*sizeof(Vertex); }
+    VkDeviceSize instsOffset() const { return indsOffset()+(VkDeviceSize)sliceInds*sizeof(uint32_t); }
+    VkDeviceSize sliceBytes() const { return instsOffset()+(VkDeviceSize)sliceInsts*sizeof(InstanceData); }
+};
+
+static FrameData frames[MAX_FRAMES_IN_FLIGHT];
+static int frameIndex=0;
+static std::vector<VkFence> imageFences;
+static GpuPool vertPool, indPool;
+static DynamicRing dynRing;
+static std::vector<const ChunkMesh*> visibleChunks;
+static std::vector<InstanceData> fragInstances;
+static std::vector<InstanceBatch> fragBatches;
+static std::vector<const FragmentStore*> fragStores;
+
+static void retireBuffer(VkBuffer buf, VkDeviceMemory mem) { frames[frameIndex].garbage.push_back({buf,mem}); }
+
+static void poolCreate(GpuPool& p, VkBufferUsageFlags usage, uint32_t stride, uint32_t capacity) {
+    p.usage=usage; p.stride=stride;
+    makeBuf((VkDeviceSize)capacity*stride,usage,HOST_MEM,p.buf,p.mem);
+    void* d; VK_CHECK(vkMapMemory(dev,p.mem,0,VK_WHOLE_SIZE,0,&d)); p.mapped=(char*)d;
+    p.ranges.reset(capacity);
+}
+
+static void poolDestroy(GpuPool& p) {
+    if(p.buf==VK_NULL_HANDLE) return;
+    vkUnmapMemory(dev,p.mem); destroyBuf(p.buf,p.mem); p.mapped=nullptr;
+}
+
+// Doubles until minCapacity fits and copies the old contents across, so every
+// live range keeps its offset. Frames still in flight may read the old buffer,
+// so it is retired with the current frame instead of destroyed.
+static void poolGrow(GpuPool& p, uint32_t minCapacity) {
+    uint32_t cap=p.ranges.capacity;
+    while(cap<minCapacity) cap*=2;
+    VkBuffer nb; VkDeviceMemory nm;
+    makeBuf((VkDeviceSize)cap*p.stride,p.usage,HOST_MEM,nb,nm);
+    void* d; VK_CHECK(vkMapMemory(dev,nm,0,VK_WHOLE_SIZE,0,&d));
+    memcpy(d,p.mapped,(size_t)p.ranges.capacity*p.stride);
+    vkUnmapMemory(dev,p.mem); retireBuffer(p.buf,p.mem);
+    p.buf=nb; p.mem=nm; p.mapped=(char*)d; p.ranges.grow(cap);
+}
+
+static uint32_t poolAlloc(GpuPool& p, uint32_t count) {
+    uint32_t off;
+    while(!p.ranges.alloc(count,off)) poolGrow(p,p.ranges.capacity+count);
+    return off;
+}
+
+static void poolFree(GpuPool& p, uint32_t offset, uint32_t count) {
+    if(count) frames[frameIndex].frees.push_back({&p.ranges,offset,count});
+}
+
+static void poolWrite(GpuPool& p, uint32_t offset, const void* src, uint32_t count) {
+    memcpy(p.mapped+(size_t)offset*p.stride,src,(size_t)count*p.stride);
+}
+
+static void ringCreate(DynamicRing& ring, uint32_t verts, uint32_t inds, uint32_t insts) {
+    ring.sliceVerts=verts; ring.sliceInds=inds; ring.sliceInsts=insts;
+    makeBuf(ring.sliceBytes()*framesInFlight,VK_BUFFER_USAGE_VERTEX_BUFFER_BIT|VK_BUFFER_USAGE_INDEX_BUFFER_BIT,HOST_MEM,ring.buf,ring.mem);
+    void* d; VK_CHECK(vkMapMemory(dev,ring.mem,0,VK_WHOLE_SIZE,0,&d)); ring.mapped=(char*)d;
+}
+
+// Called once this frame's fence has signalled: everything it deferred is now unused.
+static void retireFrame(FrameData& f) {
+    for(auto& pf:f.frees) pf.ranges->release(pf.offset,pf.count);
+    f.frees.clear();
+    for(auto& g:f.garbage) destroyBuf(g.first,g.second);
+    f.garbage.clear();
+}
+
 static void makeDepth() {
     VkImageCreateInfo ii={}; ii.sType=VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO; ii.imageType=VK_IMAGE_TYPE_2D; ii.format=VK_FORMAT_D32_SFLOAT;
     ii.extent={swapExt.width,swapExt.height,1}; ii.mipLevels=1; ii.arrayLayers=1; ii.samples=VK_SAMPLE_COUNT_1_BIT; ii.tiling=VK_IMAGE_TILING_OPTIMAL;
@@ -401,14 +331,28 @@ static void initVulkan() {
     VkPipelineDepthStencilStateCreateInfo dss={}; dss.sType=VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO; dss.depthTestEnable=VK_TRUE; dss.depthWriteEnable=VK_TRUE; dss.depthCompareOp=VK_COMPARE_OP_LESS;
     VkPipelineColorBlendAttachmentState cba={}; cba.colorWriteMask=0xF;
     VkPipelineColorBlendStateCreateInfo cb={}; cb.sType=VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO; cb.attachmentCount=1; cb.pAttachments=&cba;
-    VkPushConstantRange pcr={}; pcr.stageFlags=VK_SHADER_STAGE_VERTEX_BIT; pcr.size=sizeof(PushConstants);
+    VkDescriptorSetLayoutBinding lb={}; lb.binding=0; lb.descriptorType=VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER; lb.descriptorCount=1; lb.stageFlags=VK_SHADER_STAGE_FRAGMENT_BIT;
+    VkDescriptorSetLayoutCreateInfo dli={}; dli.sType=VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO; dli.bindingCount=1; dli.pBindings=&lb;
+    VK_CHECK(vkCreateDescriptorSetLayout(dev,&dli,nullptr,&descLayout));
+    VkPushConstantRange pcr={}; pcr.stageFlags=VK_SHADER_STAGE_VERTEX_BIT|VK_SHADER_STAGE_FRAGMENT_BIT; pcr.size=sizeof(PushConstants);
     VkPipelineLayoutCreateInfo pli={}; pli.sType=VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO; pli.pushConstantRangeCount=1; pli.pPushConstantRanges=&pcr;
+    pli.setLayoutCount=1; pli.pSetLayouts=&descLayout;
     VK_CHECK(vkCreatePipelineLayout(dev,&pli,nullptr,&pipLayout));
     VkGraphicsPipelineCreateInfo gpi={}; gpi.sType=VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO; gpi.stageCount=2; gpi.pStages=stg;
     gpi.pVertexInputState=&vin; gpi.pInputAssemblyState=&ia; gpi.pViewportState=&vs; gpi.pRasterizationState=&rs;
     gpi.pMultisampleState=&ms; gpi.pDepthStencilState=&dss; gpi.pColorBlendState=&cb; gpi.layout=pipLayout; gpi.renderPass=rpass;
     VK_CHECK(vkCreateGraphicsPipelines(dev,VK_NULL_HANDLE,1,&gpi,nullptr,&pipeline));
-    vkDestroyShaderModule(dev,vm,nullptr); vkDestroyShaderModule(dev,fm,nullptr);
+    auto ivc=loadSPV("inst.spv"); smi.codeSize=ivc.size()*4; smi.pCode=ivc.data();
+    VkShaderModule ivm; VK_CHECK(vkCreateShaderModule(dev,&smi,nullptr,&ivm)); stg[0].module=ivm;
+    VkVertexInputBindingDescription ibind[2]={bind,{}}; ibind[1].binding=1; ibind[1].stride=sizeof(InstanceData); ibind[1].inputRate=VK_VERTEX_INPUT_RATE_INSTANCE;
+    VkVertexInputAttributeDescription iatr[7]={atr[0],atr[1],atr[2]};
+    iatr[3].location=3; iatr[3].binding=1; iatr[3].format=VK_FORMAT_R32G32B32_SFLOAT; iatr[3].offset=offsetof(InstanceData,position);
+    iatr[4].location=4; iatr[4].binding=1; iatr[4].format=VK_FORMAT_R32G32B32_SFLOAT; iatr[4].offset=offsetof(InstanceData,rotation);
+    iatr[5].location=5; iatr[5].binding=1; iatr[5].format=VK_FORMAT_R32G32B32_SFLOAT; iatr[5].offset=offsetof(InstanceData,scale);
+    iatr[6].location=6; iatr[6].binding=1; iatr[6].format=VK_FORMAT_R32G32B32_SFLOAT; iatr[6].offset=offsetof(InstanceData,tint);
+    vin.vertexBindingDescriptionCount=2; vin.pVertexBindingDescriptions=ibind; vin.vertexAttributeDescriptionCount=7; vin.pVertexAttributeDescriptions=iatr;
+    VK_CHECK(vkCreateGraphicsPipelines(dev,VK_NULL_HANDLE,1,&gpi,nullptr,&instPipeline));
+    vkDestroyShaderModule(dev,vm,nullptr); vkDestroyShaderModule(dev,fm,nullptr); vkDestroyShaderModule(dev,ivm,nullptr);
     fbufs.resize(swapViews.size());
     for(size_t i=0;i<swapViews.size();i++) {
         VkImageView a[]={swapViews[i],depView};
@@ -419,49 +363,57 @@ static void initVulkan() {
     VkCommandPoolCreateInfo cpi={}; cpi.sType=VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO; cpi.flags=VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT; cpi.queueFamilyIndex=gfxFam;
     VK_CHECK(vkCreateCommandPool(dev,&cpi,nullptr,&cmdPool));
     VkCommandBufferAllocateInfo cai={}; cai.sType=VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO; cai.commandPool=cmdPool; cai.level=VK_COMMAND_BUFFER_LEVEL_PRIMARY; cai.commandBufferCount=1;
-    VK_CHECK(vkAllocateCommandBuffers(dev,&cai,&cmdBuf));
     VkSemaphoreCreateInfo semi={}; semi.sType=VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-    VK_CHECK(vkCreateSemaphore(dev,&semi,nullptr,&imgSem)); VK_CHECK(vkCreateSemaphore(dev,&semi,nullptr,&renSem));
     VkFenceCreateInfo fi2={}; fi2.sType=VK_STRUCTURE_TYPE_FENCE_CREATE_INFO; fi2.flags=VK_FENCE_CREATE_SIGNALED_BIT;
-    VK_CHECK(vkCreateFence(dev,&fi2,nullptr,&fence));
+    for(int i=0;i<framesInFlight;i++) {
+        VK_CHECK(vkAllocateCommandBuffers(dev,&cai,&frames[i].cmd));
+        VK_CHECK(vkCreateSemaphore(dev,&semi,nullptr,&frames[i].imgSem)); VK_CHECK(vkCreateSemaphore(dev,&semi,nullptr,&frames[i].renSem));
+        VK_CHECK(vkCreateFence(dev,&fi2,nullptr,&frames[i].fence));
+    }
+    imageFences.assign(swapImgs.size(),VK_NULL_HANDLE);
+    poolCreate(vertPool,VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,sizeof(Vertex),1<<18);
+    poolCreate(indPool,VK_BUFFER_USAGE_INDEX_BUFFER_BIT,sizeof(uint32_t),1<<19);
+    ringCreate(dynRing,1<<14,1<<15,1<<12);
+    makeBuf(sizeof(LightUniforms),VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,HOST_MEM,lightBuf,lightMem);
+    VkDescriptorPoolSize ps={VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,1};
+    VkDescriptorPoolCreateInfo dpi={}; dpi.sType=VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO; dpi.maxSets=1; dpi.poolSizeCount=1; dpi.pPoolSizes=&ps;
+    VK_CHECK(vkCreateDescriptorPool(dev,&dpi,nullptr,&descPool));
+    VkDescriptorSetAllocateInfo dsa={}; dsa.sType=VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO; dsa.descriptorPool=descPool; dsa.descriptorSetCount=1; dsa.pSetLayouts=&descLayout;
+    VK_CHECK(vkAllocateDescriptorSets(dev,&dsa,&lightSet));
+    VkDescriptorBufferInfo dbi={lightBuf,0,sizeof(LightUniforms)};
+    VkWriteDescriptorSet wds={}; wds.sType=VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; wds.dstSet=lightSet; wds.dstBinding=0; wds.descriptorCount=1;
+    wds.descriptorType=VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER; wds.pBufferInfo=&dbi;
+    vkUpdateDescriptorSets(dev,1,&wds,0,nullptr);
+}
+
+// Lighting is static for the session, so the uniform block is written once.
+static void uploadLighting() {
+    LightUniforms u=packLightUniforms(cityLight);
+    void* d; VK_CHECK(vkMapMemory(dev,lightMem,0,sizeof(u),0,&d)); memcpy(d,&u,sizeof(u)); vkUnmapMemory(dev,lightMem);
 }
 
-static void rebuild() {
+static OcclusionBuffer occlusionBuffer;
+
+// Draw lists for the frame: only what is within renderDist, inside the
+// frustum of `viewProj` and not hidden behind the nearby walls and ground
+// is drawn.
+static void rebuild(const Mat4& viewProj) {
     allVerts.clear(); allInds.clear();
-    Vec3 eye=getEyePos();
+    Vec3 eye=getRenderEyePos();
     float renderDist=80.0f;
-    for(auto& bl:worldBlocks) {
-        if(!bl.active) continue;
-        Vec3 d=bl.position-eye;
-        if(d.lengthSq()>renderDist*renderDist) continue;
-        size_t startIdx=allVerts.size();
-        genCubeOptimized(bl.position,bl.color,BLOCK_SIZE,allVerts,allInds);
-        for(size_t i=startIdx;i<allVerts.size();i++) {
-            allVerts[i].color=computeFullLighting(allVerts[i].pos,allVerts[i].normal,allVerts[i].color,eye);
-        }
-    }
+    Frustum frustum=Frustum::fromMatrix(viewProj);
+    cullStats=CullStats();
+    updateChunkMeshes();
+    occlusionBuffer.begin(viewProj);
+    drawChunkOccluders(occlusionBuffer,eye,frustum);
+    collectVisibleChunks(eye,renderDist,visibleChunks,&frustum,&occlusionBuffer);
     if(hasTarget&&targetBlockIdx>=0&&targetBlockIdx<(int)worldBlocks.size()) {
         Block& tb=worldBlocks[targetBlockIdx];
         if(tb.active) genCubeHighlight(tb.position,{1.0f,1.0f,1.0f},BLOCK_SIZE,allVerts,allInds);
     }
-    for(auto& fr:fragments) {
-        if(!fr.active) continue;
-        uint32_t base=(uint32_t)allVerts.size();
-        float cX=cosf(fr.rotation.x),sX=sinf(fr.rotation.x);
-        float cY=cosf(fr.rotation.y),sY=sinf(fr.rotation.y);
-        float cZ=cosf(fr.rotation.z),sZ=sinf(fr.rotation.z);
-        for(auto& v:fr.vertices) {
-            Vertex nv=v; Vec3 p=v.pos;
-            p.x*=fr.scale.x; p.y*=fr.scale.y; p.z*=fr.scale.z;
-            float y1=p.y*cX-p.z*sX,z1=p.y*sX+p.z*cX; p.y=y1; p.z=z1;
-            float x2=p.x*cY+p.z*sY,z2=-p.x*sY+p.z*cY; p.x=x2; p.z=z2;
-            float x3=p.x*cZ-p.y*sZ,y3=p.x*sZ+p.y*cZ; p.x=x3; p.y=y3;
-            nv.pos=p+fr.position;
-            nv.color=computeFullLighting(nv.pos,nv.normal,nv.color,eye);
-            allVerts.push_back(nv);
-        }
-        for(auto idx:fr.indices) allInds.push_back(base+idx);
-    }
+    collectFragmentStores(fragStores);
+    buildFragmentInstances(fragStores,fragInstances,fragBatches,renderAlpha,&frustum,&occlusionBuffer);
+    buildParticleInstances(fragInstances,fragBatches,renderAlpha,&frustum);
     Vec3 right=getCamRight(), fwd=getCamForward();
     Vec3 up2=Vec3::cross(right,fwd).normalized();
     Vec3 crossPos=eye+fwd*0.3f; float cs=0.003f;
@@ -475,69 +427,113 @@ static void rebuild() {
     if(allVerts.empty()) { allVerts.push_back({{0,0,0},{0,1,0},{0,0,0}}); allInds.push_back(0); allInds.push_back(0); allInds.push_back(0); }
 }
 
+static void uploadChunkMeshes() {
+    for(const ReleasedChunkRange& r:releasedChunkRanges) { poolFree(vertPool,r.vtxOffset,r.vtxCount); poolFree(indPool,r.idxOffset,r.idxCount); }
+    releasedChunkRanges.clear();
+    for(auto& kv:chunkMeshes) {
+        ChunkMesh& m=kv.second;
+        if(!m.gpuStale) continue;
+        poolFree(vertPool,m.gpuVtxOffset,m.gpuVtxCount); poolFree(indPool,m.gpuIdxOffset,m.gpuIdxCount);
+        m.gpuVtxCount=(uint32_t)m.verts.size(); m.gpuIdxCount=(uint32_t)m.inds.size();
+        m.gpuVtxOffset=poolAlloc(vertPool,m.gpuVtxCount); m.gpuIdxOffset=poolAlloc(indPool,m.gpuIdxCount);
+        poolWrite(vertPool,m.gpuVtxOffset,m.verts.data(),m.gpuVtxCount);
+        poolWrite(indPool,m.gpuIdxOffset,m.inds.data(),m.gpuIdxCount);
+        m.gpuStale=false;
+    }
+}
+
+// Fragment meshes are written once when created; released ones give their
+// ranges back (deferred with the frame) before their ids are reused.
+static void uploadMeshLibrary() {
+    for(int id:releasedMeshIds) {
+        MeshData& m=meshLibrary[id];
+        poolFree(vertPool,m.gpuVtxOffset,m.gpuVtxCount); poolFree(indPool,m.gpuIdxOffset,m.gpuIdxCount);
+        m.gpuVtxCount=m.gpuIdxCount=0; freeMeshIds.push_back(id);
+    }
+    releasedMeshIds.clear();
+    for(auto& m:meshLibrary) {
+        if(m.refs<=0||!m.gpuStale) continue;
+        m.gpuVtxCount=(uint32_t)m.verts.size(); m.gpuIdxCount=(uint32_t)m.inds.size();
+        m.gpuVtxOffset=poolAlloc(vertPool,m.gpuVtxCount); m.gpuIdxOffset=poolAlloc(indPool,m.gpuIdxCount);
+        poolWrite(vertPool,m.gpuVtxOffset,m.verts.data(),m.gpuVtxCount);
+        poolWrite(indPool,m.gpuIdxOffset,m.inds.data(),m.gpuIdxCount);
+        m.gpuStale=false;
+    }
+}
+
+// Chunk and fragment meshes only change on re-mesh or fracture; the dynamic
+// geometry and fragment instances go into this frame's ring slice every frame,
+// since the other slices may still be in use.
 static void uploadBufs() {
-    vkDeviceWaitIdle(dev); destroyBuf(vBuf,vMemory); destroyBuf(iBuf,iMemory);
-    VkDeviceSize vsz=allVerts.size()*sizeof(Vertex), isz=allInds.size()*sizeof(uint32_t);
-    makeBuf(vsz,VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,vBuf,vMemory);
-    void* d; vkMapMemory(dev,vMemory,0,vsz,0,&d); memcpy(d,allVerts.data(),vsz); vkUnmapMemory(dev,vMemory);
-    makeBuf(isz,VK_BUFFER_USAGE_INDEX_BUFFER_BIT,VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,iBuf,iMemory);
-    vkMapMemory(dev,iMemory,0,isz,0,&d); memcpy(d,allInds.data(),isz); vkUnmapMemory(dev,iMemory);
+    uploadChunkMeshes();
+    uploadMeshLibrary();
+    uint32_t vc=(uint32_t)allVerts.size(), ic=(uint32_t)allInds.size(), nc=(uint32_t)fragInstances.size();
+    if(vc>dynRing.sliceVerts||ic>dynRing.sliceInds||nc>dynRing.sliceInsts) {
+        vkUnmapMemory(dev,dynRing.mem); retireBuffer(dynRing.buf,dynRing.mem);
+        ringCreate(dynRing,std::max(vc+vc/2,dynRing.sliceVerts),std::max(ic+ic/2,dynRing.sliceInds),std::max(nc+nc/2,dynRing.sliceInsts));
+    }
+    char* slice=dynRing.mapped+dynRing.sliceBytes()*frameIndex;
+    memcpy(slice,allVerts.data(),(size_t)vc*sizeof(Vertex));
+    memcpy(slice+dynRing.indsOffset(),allInds.data(),(size_t)ic*sizeof(uint32_t));
+    memcpy(slice+dynRing.instsOffset(),fragInstances.data(),(size_t)nc*sizeof(InstanceData));
 }
 
-static void physics(float dt) {
-    Vec3 fwd=getCamForward(), right=getCamRight();
-    Vec3 flatFwd={fwd.x,0,fwd.z}; flatFwd=flatFwd.normalized();
-    Vec3 flatRight={right.x,0,right.z}; flatRight=flatRight.normalized();
-    Vec3 moveDir={0,0,0};
-    if(keys['W']) moveDir+=flatFwd;
-    if(keys['S']) moveDir-=flatFwd;
-    if(keys['A']) moveDir-=flatRight;
-    if(keys['D']) moveDir+=flatRight;
-    if(moveDir.lengthSq()>0.0001f) moveDir=moveDir.normalized();
-    Vec3 newPos=playerPos;
-    newPos.x+=moveDir.x*MOVE_SPEED*dt;
-    if(collidesPlayerFast(newPos)) newPos.x=playerPos.x;
-    newPos.z+=moveDir.z*MOVE_SPEED*dt;
-    if(collidesPlayerFast(newPos)) newPos.z=playerPos.z;
-    playerVel.y-=GRAVITY*dt;
-    if(keys[VK_SPACE]&&onGround) { playerVel.y=JUMP_SPEED; onGround=false; }
-    newPos.y+=playerVel.y*dt;
-    if(collidesPlayerFast(newPos)) { if(playerVel.y<0) onGround=true; playerVel.y=0; newPos.y=playerPos.y; } else onGround=false;
-    if(newPos.y<0) { newPos.y=0; playerVel.y=0; onGround=true; }
-    playerPos=newPos;
-
-    updateAllFragments(dt);
-
-    findTarget(); dirty=true;
+static SimInput readInput() {
+    SimInput in;
+    in.forward=(keys['W']?1.0f:0.0f)-(keys['S']?1.0f:0.0f);
+    in.strafe=(keys['D']?1.0f:0.0f)-(keys['A']?1.0f:0.0f);
+    in.jump=keys[VK_SPACE];
+    return in;
 }
 
 static void render() {
-    vkWaitForFences(dev,1,&fence,VK_TRUE,UINT64_MAX); vkResetFences(dev,1,&fence);
-    uint32_t idx; VkResult acq=vkAcquireNextImageKHR(dev,swapchain,UINT64_MAX,imgSem,VK_NULL_HANDLE,&idx);
-    if(acq!=VK_SUCCESS) return;
-    if(dirty) { rebuild(); uploadBufs(); dirty=false; }
-    Vec3 eye=getEyePos(), target=eye+getCamForward();
-    Mat4 view=Mat4::lookAt(eye,target,{0,1,0});
-    Mat4 proj=Mat4::perspective(PI/3.0f,(float)swapExt.width/(float)swapExt.height,0.05f,500.0f);
-    PushConstants pc; pc.mvp=proj*view;
-    vkResetCommandBuffer(cmdBuf,0);
-    VkCommandBufferBeginInfo bi={}; bi.sType=VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO; vkBeginCommandBuffer(cmdBuf,&bi);
+    FrameData& fr=frames[frameIndex];
+    vkWaitForFences(dev,1,&fr.fence,VK_TRUE,UINT64_MAX);
+    retireFrame(fr);
+    uint32_t idx; VkResult acq=vkAcquireNextImageKHR(dev,swapchain,UINT64_MAX,fr.imgSem,VK_NULL_HANDLE,&idx);
+    if(acq!=VK_SUCCESS&&acq!=VK_SUBOPTIMAL_KHR) return;
+    if(imageFences[idx]!=VK_NULL_HANDLE&&imageFences[idx]!=fr.fence) vkWaitForFences(dev,1,&imageFences[idx],VK_TRUE,UINT64_MAX);
+    imageFences[idx]=fr.fence;
+    vkResetFences(dev,1,&fr.fence);
+    Vec3 eye=getRenderEyePos();
+    PushConstants pc; pc.mvp=cameraViewProj(eye,(float)swapExt.width/(float)swapExt.height); pc.eye=eye; pc.pad=0;
+    if(dirty) { rebuild(pc.mvp); dirty=false; }
+    uploadBufs();
+    VkCommandBuffer cmd=fr.cmd;
+    vkResetCommandBuffer(cmd,0);
+    VkCommandBufferBeginInfo bi={}; bi.sType=VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO; vkBeginCommandBuffer(cmd,&bi);
     VkClearValue cl[2]={}; cl[0].color={{0.35f,0.38f,0.42f,1.0f}}; cl[1].depthStencil={1.0f,0};
     VkRenderPassBeginInfo rb={}; rb.sType=VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO; rb.renderPass=rpass; rb.framebuffer=fbufs[idx];
     rb.renderArea={{0,0},swapExt}; rb.clearValueCount=2; rb.pClearValues=cl;
-    vkCmdBeginRenderPass(cmdBuf,&rb,VK_SUBPASS_CONTENTS_INLINE);
-    vkCmdBindPipeline(cmdBuf,VK_PIPELINE_BIND_POINT_GRAPHICS,pipeline);
-    VkDeviceSize off=0; vkCmdBindVertexBuffers(cmdBuf,0,1,&vBuf,&off);
-    vkCmdBindIndexBuffer(cmdBuf,iBuf,0,VK_INDEX_TYPE_UINT32);
-    vkCmdPushConstants(cmdBuf,pipLayout,VK_SHADER_STAGE_VERTEX_BIT,0,sizeof(PushConstants),&pc);
-    vkCmdDrawIndexed(cmdBuf,(uint32_t)allInds.size(),1,0,0,0);
-    vkCmdEndRenderPass(cmdBuf); vkEndCommandBuffer(cmdBuf);
+    vkCmdBeginRenderPass(cmd,&rb,VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBindPipeline(cmd,VK_PIPELINE_BIND_POINT_GRAPHICS,pipeline);
+    vkCmdBindDescriptorSets(cmd,VK_PIPELINE_BIND_POINT_GRAPHICS,pipLayout,0,1,&lightSet,0,nullptr);
+    vkCmdPushConstants(cmd,pipLayout,VK_SHADER_STAGE_VERTEX_BIT|VK_SHADER_STAGE_FRAGMENT_BIT,0,sizeof(PushConstants),&pc);
+    VkDeviceSize off=0; vkCmdBindVertexBuffers(cmd,0,1,&vertPool.buf,&off);
+    vkCmdBindIndexBuffer(cmd,indPool.buf,0,VK_INDEX_TYPE_UINT32);
+    for(const ChunkMesh* m:visibleChunks) vkCmdDrawIndexed(cmd,m->gpuIdxCount,1,m->gpuIdxOffset,(int32_t)m->gpuVtxOffset,0);
+    VkDeviceSize sliceOff=dynRing.sliceBytes()*frameIndex;
+    vkCmdBindVertexBuffers(cmd,0,1,&dynRing.buf,&sliceOff);
+    vkCmdBindIndexBuffer(cmd,dynRing.buf,sliceOff+dynRing.indsOffset(),VK_INDEX_TYPE_UINT32);
+    vkCmdDrawIndexed(cmd,(uint32_t)allInds.size(),1,0,0,0);
+    if(!fragBatches.empty()) {
+        vkCmdBindPipeline(cmd,VK_PIPELINE_BIND_POINT_GRAPHICS,instPipeline);
+        VkBuffer ib[2]={vertPool.buf,dynRing.buf}; VkDeviceSize io[2]={0,sliceOff+dynRing.instsOffset()};
+        vkCmdBindVertexBuffers(cmd,0,2,ib,io);
+        vkCmdBindIndexBuffer(cmd,indPool.buf,0,VK_INDEX_TYPE_UINT32);
+        for(auto& b:fragBatches) {
+            const MeshData& m=meshLibrary[b.mesh];
+            vkCmdDrawIndexed(cmd,m.gpuIdxCount,b.count,m.gpuIdxOffset,(int32_t)m.gpuVtxOffset,b.first);
+        }
+    }
+    vkCmdEndRenderPass(cmd); vkEndCommandBuffer(cmd);
     VkPipelineStageFlags ws=VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-    VkSubmitInfo subi={}; subi.sType=VK_STRUCTURE_TYPE_SUBMIT_INFO; subi.waitSemaphoreCount=1; subi.pWaitSemaphores=&imgSem;
-    subi.pWaitDstStageMask=&ws; subi.commandBufferCount=1; subi.pCommandBuffers=&cmdBuf; subi.signalSemaphoreCount=1; subi.pSignalSemaphores=&renSem;
-    vkQueueSubmit(gfxQueue,1,&subi,fence);
-    VkPresentInfoKHR pi={}; pi.sType=VK_STRUCTURE_TYPE_PRESENT_INFO_KHR; pi.waitSemaphoreCount=1; pi.pWaitSemaphores=&renSem;
+    VkSubmitInfo subi={}; subi.sType=VK_STRUCTURE_TYPE_SUBMIT_INFO; subi.waitSemaphoreCount=1; subi.pWaitSemaphores=&fr.imgSem;
+    subi.pWaitDstStageMask=&ws; subi.commandBufferCount=1; subi.pCommandBuffers=&cmd; subi.signalSemaphoreCount=1; subi.pSignalSemaphores=&fr.renSem;
+    vkQueueSubmit(gfxQueue,1,&subi,fr.fence);
+    VkPresentInfoKHR pi={}; pi.sType=VK_STRUCTURE_TYPE_PRESENT_INFO_KHR; pi.waitSemaphoreCount=1; pi.pWaitSemaphores=&fr.renSem;
     pi.swapchainCount=1; pi.pSwapchains=&swapchain; pi.pImageIndices=&idx; vkQueuePresentKHR(presQueue,&pi);
+    frameIndex=(frameIndex+1)%framesInFlight;
 }
 
 static void lockMouse() {
@@ -547,13 +543,39 @@ static void lockMouse() {
 
 static void unlockMouse() { ShowCursor(TRUE); mouseLocked=false; }
 
+// The window title: the key help, then what the last key did.
+static const char* KEY_HELP="[LMB:Destroy F2:Cull F3:Eternal F4:Clear F5:Mesh F6:Bench F7:Patterns F8:Arena F9:Save F11:Step ESC:Quit]";
+
+static void setStatus(const char* fmt, ...) {
+    char t[512]; int n=snprintf(t,sizeof(t),"%s ",KEY_HELP);
+    va_list args; va_start(args,fmt); vsnprintf(t+n,sizeof(t)-n,fmt,args); va_end(args);
+    SetWindowTextA(hwnd,t);
+}
+
 LRESULT CALLBACK WndProc(HWND h, UINT msg, WPARAM w, LPARAM l) {
     switch(msg) {
     case WM_DESTROY: running=false; PostQuitMessage(0); return 0;
     case WM_KEYDOWN:
         keys[w&0xFF]=true;
-        if(w==VK_F3) { fragmentsEternal=!fragmentsEternal; for(auto& f:fragments) { f.eternal=fragmentsEternal; if(!fragmentsEternal) { f.lifetime=0; f.maxLifetime=fragmentTimeout; } } }
-        if(w==VK_F4) { fragments.clear(); dirty=true; }
+        if(w==VK_F3) { fragmentsEternal=!fragmentsEternal; setFragmentsEternal(fragmentsEternal); setParticlesEternal(fragmentsEternal); }
+        if(w==VK_F4) { flushFractureJobs(); clearFragments(); clearParticles(); dirty=true; }
+        if(w==VK_F5) {
+            setChunkMeshMode(chunkMeshMode==MESH_GREEDY?MESH_CULLED:MESH_GREEDY); updateChunkMeshes(); dirty=true;
+            setStatus("mesh=%s tris=%zu",chunkMeshMode==MESH_GREEDY?"greedy":"culled",chunkTriangleCount());
+        }
+        if(w==VK_F7) { useFracturePatterns=!useFracturePatterns; setStatus(useFracturePatterns?"fracture=patterns":"fracture=procedural"); }
+        if(w==VK_F2) {
+            setStatus("frustum/occluded of tested: chunks=%u/%u/%u fragments=%u/%u/%u particles=%u/-/%u occluders=%u",
+                cullStats.chunksCulled,cullStats.chunksOccluded,cullStats.chunksTested,cullStats.fragmentsCulled,cullStats.fragmentsOccluded,cullStats.fragmentsTested,
+                cullStats.particlesCulled,cullStats.particlesTested,cullStats.occluderQuads);
+        }
+        if(w==VK_F8) {
+            setStatus("arena=%zuKB fallbacks=%llu in %llu frames",
+                frameArena.highWater/1024,(unsigned long long)frameArena.fallbackAllocs,(unsigned long long)frameArena.fallbackFrames);
+        }
+        if(w==VK_F9) { flushFractureJobs(); flushStreaming(); bool ok=saveWorldSnapshot("world.c17"); setStatus(ok?"world.c17 written":"world.c17 could not be written"); }
+        if(w==VK_F11) { playerStepUp=!playerStepUp; setStatus(playerStepUp?"step-up=on":"step-up=off"); }
+        if(w==VK_F6) { benchFragmentCollision("bench_output.txt"); setStatus("bench_output.txt written"); }
         if(w==VK_ESCAPE) { if(mouseLocked) unlockMouse(); else { running=false; PostQuitMessage(0); } }
         return 0;
     case WM_KEYUP: keys[w&0xFF]=false; return 0;
@@ -562,10 +584,8 @@ case WM_LBUTTONDOWN:
     if(hasTarget&&targetBlockIdx>=0&&targetBlockIdx<(int)worldBlocks.size()) {
         Block& tb=worldBlocks[targetBlockIdx];
         if(tb.active) {
-            tb.active=false;
-            fractureAndSpawn(tb);
+            destroyBlock(targetBlockIdx);
             playStoneBreak();
-            rebuildGrid();
             dirty=true;
         }
     }
@@ -579,25 +599,41 @@ case WM_LBUTTONDOWN:
 }
 
 static void cleanup() {
+    flushFractureJobs();
+    flushStreaming();
+    clearFragments();
+    clearChunkMeshes();
     cleanupGrid();
     vkDeviceWaitIdle(dev);
-    vkDeviceWaitIdle(dev); destroyBuf(vBuf,vMemory); destroyBuf(iBuf,iMemory);
-    vkDestroyFence(dev,fence,nullptr); vkDestroySemaphore(dev,renSem,nullptr); vkDestroySemaphore(dev,imgSem,nullptr);
+    for(int i=0;i<framesInFlight;i++) {
+        retireFrame(frames[i]);
+        vkDestroyFence(dev,frames[i].fence,nullptr); vkDestroySemaphore(dev,frames[i].renSem,nullptr); vkDestroySemaphore(dev,frames[i].imgSem,nullptr);
+    }
+    poolDestroy(vertPool); poolDestroy(indPool);
+    vkUnmapMemory(dev,dynRing.mem); destroyBuf(dynRing.buf,dynRing.mem);
+    destroyBuf(lightBuf,lightMem); vkDestroyDescriptorPool(dev,descPool,nullptr); vkDestroyDescriptorSetLayout(dev,descLayout,nullptr);
     vkDestroyCommandPool(dev,cmdPool,nullptr);
     for(auto fb:fbufs) vkDestroyFramebuffer(dev,fb,nullptr);
-    vkDestroyPipeline(dev,pipeline,nullptr); vkDestroyPipelineLayout(dev,pipLayout,nullptr); vkDestroyRenderPass(dev,rpass,nullptr);
+    vkDestroyPipeline(dev,pipeline,nullptr); vkDestroyPipeline(dev,instPipeline,nullptr); vkDestroyPipelineLayout(dev,pipLayout,nullptr); vkDestroyRenderPass(dev,rpass,nullptr);
     vkDestroyImageView(dev,depView,nullptr); vkDestroyImage(dev,depImg,nullptr); vkFreeMemory(dev,depMem,nullptr);
     for(auto iv:swapViews) vkDestroyImageView(dev,iv,nullptr);
     vkDestroySwapchainKHR(dev,swapchain,nullptr); vkDestroyDevice(dev,nullptr);
     vkDestroySurfaceKHR(vkInst,surf,nullptr); vkDestroyInstance(vkInst,nullptr);
 }
 
-int WINAPI WinMain(HINSTANCE hI, HINSTANCE, LPSTR, int) {
+int WINAPI WinMain(HINSTANCE hI, HINSTANCE, LPSTR cmdLine, int) {
+    const char* fa=strstr(cmdLine,"-frames"); if(fa) framesInFlight=std::max(1,std::min(MAX_FRAMES_IN_FLIGHT,atoi(fa+7)));
+    const char* ta=strstr(cmdLine,"-threads"); initJobs(ta?atoi(ta+8):-1);
+    const char* ra=strstr(cmdLine,"-tickrate"); if(ra) simTickHz=std::max(10,std::min(1000,atoi(ra+9)));
+    const char* ma=strstr(cmdLine,"-maxticks"); if(ma) maxTicksPerFrame=std::max(1,atoi(ma+9));
+    char worldPath[260]={}; const char* wa=strstr(cmdLine,"-world"); if(wa) sscanf(wa+6,"%259s",worldPath);
+    bool stream=strstr(cmdLine,"-stream")!=nullptr;
     WNDCLASS wc={}; wc.lpfnWndProc=WndProc; wc.hInstance=hI; wc.lpszClassName="C17"; wc.hCursor=LoadCursor(nullptr,IDC_ARROW);
     RegisterClass(&wc);
-    hwnd=CreateWindowEx(0,"C17","[LMB:Destroy F3:Eternal F4:Clear ESC:Quit]",WS_OVERLAPPEDWINDOW|WS_VISIBLE,CW_USEDEFAULT,CW_USEDEFAULT,winW,winH,nullptr,nullptr,hI,nullptr);
-    initVulkan(); initSounds(); initLighting(); generateCity17(); rebuildGrid(); dirty=true; lockMouse();
-    auto lt=std::chrono::high_resolution_clock::now(); MSG msg;
+    hwnd=CreateWindowEx(0,"C17",KEY_HELP,WS_OVERLAPPEDWINDOW|WS_VISIBLE,CW_USEDEFAULT,CW_USEDEFAULT,winW,winH,nullptr,nullptr,hI,nullptr);
+    initVulkan(); initSounds(); initLighting(); uploadLighting(); if(stream) beginStreamingWorld(42); else if(!worldPath[0]||!loadWorldSnapshot(worldPath)) buildCity17Grid(42); initFracturePatterns(); dirty=true; lockMouse();
+    prevPlayerPos=playerPos;
+    auto lt=std::chrono::high_resolution_clock::now(); MSG msg; double acc=0;
     while(running) {
         while(PeekMessage(&msg,nullptr,0,0,PM_REMOVE)) { TranslateMessage(&msg); DispatchMessage(&msg); }
         if(mouseLocked) {
@@ -607,9 +643,8 @@ int WINAPI WinMain(HINSTANCE hI, HINSTANCE, LPSTR, int) {
             RECT r; GetClientRect(hwnd,&r); POINT c={(r.right-r.left)/2,(r.bottom-r.top)/2};
             ClientToScreen(hwnd,&c); SetCursorPos(c.x,c.y); lastMouse=c;
         }
-        auto now=std::chrono::high_resolution_clock::now(); float dt=std::chrono::duration<float>(now-lt).count(); lt=now;
-        if(dt>0.05f) dt=0.05f;
-        physics(dt); render();
+        auto now=std::chrono::high_resolution_clock::now(); acc+=std::min(std::chrono::duration<double>(now-lt).count(),0.25); lt=now;
+        tickSimulation(acc,readInput()); findTarget(); dirty=true; render(); frameArena.reset();
     }
-    cleanup(); return 0;
+    cleanup(); shutdownJobs(); return 0;
 }
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+// Shared store for fragment meshes. A mesh is built once on the CPU, uploaded
+// once into the GPU pools by the renderer, and drawn per instance with the
+// fragment's transform. Ids are recycled after the renderer has dropped the
+// GPU ranges of a released mesh.
+struct MeshData {
+    std::vector<Vertex> verts;
+    std::vector<uint32_t> inds;
+    float radius = 0;
+    int refs = 0;
+    uint32_t gpuVtxOffset = 0, gpuVtxCount = 0;
+    uint32_t gpuIdxOffset = 0, gpuIdxCount = 0;
+    bool gpuStale = true;
+};
+
+static std::vector<MeshData> meshLibrary;
+static std::vector<int> freeMeshIds;
+static std::vector<int> releasedMeshIds;
+
+static int createMesh(std::vector<Vertex>&& V, std::vector<uint32_t>&& I) {
+    int id;
+    if (!freeMeshIds.empty()) { id = freeMeshIds.back(); freeMeshIds.pop_back(); }
+    else { id = (int)meshLibrary.size(); meshLibrary.emplace_back(); }
+    MeshData& m = meshLibrary[id];
+    m.verts = std::move(V);
+    m.inds = std::move(I);
+    float r2 = 0;
+    for (const Vertex& v : m.verts) r2 = std::max(r2, v.pos.lengthSq());
+    m.radius = sqrtf(r2);
+    m.refs = 1;
+    m.gpuStale = true;
+    return id;
+}
+
+static void retainMesh(int id) {
+    if (id >= 0) meshLibrary[id].refs++;
+}
+
+static void releaseMesh(int id) {
+    if (id < 0) return;
+    MeshData& m = meshLibrary[id];
+    if (--m.refs > 0) return;
+    m.verts.clear(); m.verts.shrink_to_fit();
+    m.inds.clear(); m.inds.shrink_to_fit();
+    releasedMeshIds.push_back(id);
+}
+
+// Without a renderer there are no GPU ranges to drop, so released ids can be
+// reused straight away.
+static void recycleReleasedMeshes() {
+    for (int id : releasedMeshIds) {
+        meshLibrary[id].gpuVtxCount = meshLibrary[id].gpuIdxCount = 0;
+        freeMeshIds.push_back(id);
+    }
+    releasedMeshIds.clear();
+    releasedChunkRanges.clear();
+}
+
+// A run of instances sharing one mesh, drawn with a single instanced call.
+struct InstanceBatch { int mesh; uint32_t first, count; };
+
+// Packs the fragments of every store into per-instance transforms grouped by
+// mesh, so fragments that share a mesh become one draw. `alpha` blends each
+// pose from the previous tick (0) to the latest one (1). Fragments whose
+// bounding sphere is outside the frustum or hidden in the occlusion buffer,
+// when given, are left out.
+static void buildFragmentInstances(const std::vector<const FragmentStore*>& stores, std::vector<InstanceData>& out, std::vector<InstanceBatch>& batches, float alpha,
+                                   const Frustum* frustum = nullptr, const OcclusionBuffer* occlusion = nullptr) {
+    out.clear();
+    batches.clear();
+    struct Ref { int mesh; uint32_t store, row; };
+    ArenaScope scratch(frameArena);
+    ArenaVector<Ref> order{ArenaAllocator<Ref>(frameArena)};
+    size_t rows = 0;
+    for (const FragmentStore* f : stores) rows += f->size();
+    order.reserve(rows);
+    for (uint32_t s = 0; s < (uint32_t)stores.size(); s++) {
+        const FragmentStore& f = *stores[s];
+        for (uint32_t i = 0; i < (uint32_t)f.size(); i++) {
+            if (f.mesh[i] < 0) continue;
+            if (frustum) {
+                Vec3 pos = {f.ox[i] + (f.px[i] - f.ox[i]) * alpha, f.oy[i] + (f.py[i] - f.oy[i]) * alpha, f.oz[i] + (f.pz[i] - f.oz[i]) * alpha};
+                float r = meshLibrary[f.mesh[i]].radius * std::max(f.sx[i], std::max(f.sy[i], f.sz[i]));
+                cullStats.fragmentsTested++;
+                if (!frustum->sphereVisible(pos, r)) { cullStats.fragmentsCulled++; continue; }
+                if (occlusion && !occlusion->sphereVisible(pos, r)) { cullStats.fragmentsOccluded++; continue; }
+            }
+            order.push_back({f.mesh[i], s, i});
+        }
+    }
+    std::sort(order.begin(), order.end(), [](const Ref& a, const Ref& b) { return a.mesh < b.mesh; });
+    for (auto& o : order) {
+        const FragmentStore& f = *stores[o.store];
+        uint32_t i = o.row;
+        if (batches.empty() || batches.back().mesh != o.mesh)
+            batches.push_back({o.mesh, (uint32_t)out.size(), 0});
+        Vec3 pos = {f.ox[i] + (f.px[i] - f.ox[i]) * alpha, f.oy[i] + (f.py[i] - f.oy[i]) * alpha, f.oz[i] + (f.pz[i] - f.oz[i]) * alpha};
+        Vec3 rot = {f.orx[i] + (f.rx[i] - f.orx[i]) * alpha, f.ory[i] + (f.ry[i] - f.ory[i]) * alpha, f.orz[i] + (f.rz[i] - f.orz[i]) * alpha};
+        out.push_back({pos, rot, {f.sx[i], f.sy[i], f.sz[i]}, {f.tr[i], f.tg[i], f.tb[i]}});
+        batches.back().count++;
+    }
+}
\ No newline at end of file
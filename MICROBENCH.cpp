@@ -0,0 +1,458 @@
+// Microbenchmarks for the hot simulation kernels. Built with
+// -DUSE_GOOGLE_BENCHMARK (BUILD_BENCH.sh does when the library is installed)
+// they run on Google Benchmark itself. Otherwise a small runner in this file
+// follows its conventions (flags, auto-scaled iteration counts, JSON schema)
+// so results can still be diffed with its compare.py.
+//
+// Either way the runs use UseRealTime() (iteration counts, items/s and the
+// "/real_time" name suffix), since most kernels spread over the job workers;
+// cpu_time is the CPU time of the calling thread alone, as in Google
+// Benchmark, so it undercounts parallel kernels.
+//
+//   MICROBENCH [--benchmark_filter=REGEX] [--benchmark_min_time=SECONDS]
+//              [--benchmark_out=FILE] [--benchmark_format=console|json]
+//              [--threads=N]
+#include "SIM_CORE.cpp"
+#include "PLATFORM.cpp"
+#ifdef USE_GOOGLE_BENCHMARK
+#include <benchmark/benchmark.h>
+#else
+#include <regex>
+#include <ctime>
+#endif
+
+#ifdef USE_GOOGLE_BENCHMARK
+// The runner's interface over benchmark::State, so the benchmarks below
+// build against either.
+struct BenchState {
+    benchmark::State& gb;
+    int64_t arg;
+    int64_t items = 0;
+    std::string label;
+    int64_t done = 0;
+
+    BenchState(benchmark::State& s, int64_t a) : gb(s), arg(a) {}
+
+    bool keepRunning() {
+        if (!gb.KeepRunning()) return false;
+        done++;
+        return true;
+    }
+
+    void pauseTiming() { gb.PauseTiming(); }
+    void resumeTiming() { gb.ResumeTiming(); }
+};
+#else
+struct BenchState {
+    int64_t maxIterations;
+    int64_t arg;
+    int64_t items = 0;
+    std::string label;
+
+    int64_t done = 0;
+    bool running = false;
+    std::chrono::steady_clock::time_point realStart;
+    double cpuStart = 0;
+    double realSec = 0, cpuSec = 0;
+
+    BenchState(int64_t iterations, int64_t a) : maxIterations(iterations), arg(a) {}
+
+    // `while (state.keepRunning())` runs the timed body maxIterations times.
+    bool keepRunning() {
+        if (done == 0) resumeTiming();
+        if (done == maxIterations) { pauseTiming(); return false; }
+        done++;
+        return true;
+    }
+
+    // Excludes per-iteration setup from the measurement.
+    void pauseTiming() {
+        if (!running) return;
+        realSec += std::chrono::duration<double>(std::chrono::steady_clock::now() - realStart).count();
+        cpuSec += threadCpuSeconds() - cpuStart;
+        running = false;
+    }
+
+    void resumeTiming() {
+        if (running) return;
+        realStart = std::chrono::steady_clock::now();
+        cpuStart = threadCpuSeconds();
+        running = true;
+    }
+};
+#endif
+
+struct MicroBench {
+    std::string name;
+    void (*fn)(BenchState&);
+    std::vector<int64_t> args;
+};
+
+static std::vector<MicroBench>& microBenches() {
+    static std::vector<MicroBench> list;
+    return list;
+}
+
+static void registerBench(const char* name, void (*fn)(BenchState&), std::vector<int64_t> args = {}) {
+    microBenches().push_back({name, fn, args});
+}
+
+// ---------------------------------------------------------------------------
+// Fixtures
+
+static void ensureCity() {
+    if (!worldBlocks.empty()) return;
+    buildCity17Grid(42);
+}
+
+static void resetDebris() {
+    clearFragments();
+    clearParticles();
+    recycleReleasedMeshes();
+}
+
+// ---------------------------------------------------------------------------
+// Benchmarks
+
+static void BM_clipShapeByPlane(BenchState& state) {
+    std::mt19937 g(1);
+    std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+    std::vector<Vec3> normals(64);
+    for (auto& n : normals) n = Vec3{d(g), d(g), d(g)}.normalized();
+    ConvexShape cube, a, b;
+    makeCubeShape({0, 0, 0}, 0.5f, cube);
+    size_t k = 0, faces = 0;
+    // Each plane keeps the side holding the origin, so the cuts accumulate
+    // into a shrinking convex cell the way a fracture cell does.
+    while (state.keepRunning()) {
+        const ConvexShape* src = &cube;
+        ConvexShape* dst = &a;
+        for (int64_t c = 0; c < state.arg; c++, k++) {
+            clipShapeByPlane(*src, normals[k & 63] * -0.3f, normals[k & 63], *dst);
+            src = dst;
+            dst = dst == &a ? &b : &a;
+        }
+        faces += src->faceCount;
+    }
+    state.label = std::to_string(faces / std::max<size_t>(1, state.done)) + " faces";
+    state.items = state.done * state.arg;
+}
+
+// Breaks `arg` blocks per iteration; the Procedural variant builds fresh
+// Voronoi cells and meshes instead of using the pattern library.
+static void runFractureBench(BenchState& state, bool patterns) {
+    ensureCity();
+    bool saved = useFracturePatterns;
+    useFracturePatterns = patterns;
+    initFracturePatterns();
+    Block bl;
+    bl.color = {0.4f, 0.38f, 0.35f};
+    bl.active = true;
+    bl.type = 2;
+    while (state.keepRunning()) {
+        for (int64_t i = 0; i < state.arg; i++) {
+            bl.position = {-500.0f + (float)(i % 10) * 2.0f, 2.0f, -500.0f + (float)(i / 10) * 2.0f};
+            fractureAndSpawn(bl);
+        }
+        state.pauseTiming();
+        resetDebris();
+        state.resumeTiming();
+    }
+    useFracturePatterns = saved;
+    state.items = state.done * state.arg;
+}
+
+static void BM_fractureAndSpawn(BenchState& state) { runFractureBench(state, true); }
+static void BM_fractureProcedural(BenchState& state) { runFractureBench(state, false); }
+
+static void BM_genCubeOptimized(BenchState& state) {
+    ensureCity();
+    std::vector<Vertex> V;
+    std::vector<uint32_t> I;
+    while (state.keepRunning()) {
+        V.clear();
+        I.clear();
+        for (const Block& bl : worldBlocks)
+            if (bl.active) genCubeOptimized(bl.position, bl.color, BLOCK_SIZE, V, I);
+    }
+    state.items = state.done * (int64_t)worldBlocks.size();
+    state.label = "City17";
+}
+
+// Full re-mesh of every City 17 section; arg selects culled (0) or greedy (1).
+static void BM_chunkMeshRebuild(BenchState& state) {
+    ensureCity();
+    int saved = chunkMeshMode;
+    chunkMeshMode = (int)state.arg;
+    int sections = 0;
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        for (auto& kv : blockGrid->chunks) kv.second->dirty = true;
+        state.resumeTiming();
+        sections = updateChunkMeshes();
+    }
+    chunkMeshMode = saved;
+    state.items = state.done * sections;
+    state.label = state.arg ? "greedy" : "culled";
+}
+
+// CPU side of MAIN.cpp's rebuild(): visibility plus fragment and particle
+// instance packing, with `arg` fragments alive.
+static void BM_frameRebuild(BenchState& state) {
+    ensureCity();
+    updateChunkMeshes();
+    resetDebris();
+    initParticles();
+    spawnFragmentField((int)state.arg, 7, particleMeshes[PARTICLE_DUST]);
+    std::vector<const ChunkMesh*> visible;
+    std::vector<const FragmentStore*> stores;
+    std::vector<InstanceData> instances;
+    std::vector<InstanceBatch> batches;
+    Vec3 eye = {8.0f, 4.6f, 8.0f};
+    camYaw = 0.6f;
+    camPitch = 0.1f;
+    Mat4 viewProj = cameraViewProj(eye, 16.0f / 9.0f);
+    static OcclusionBuffer occlusion;
+    while (state.keepRunning()) {
+        updateChunkMeshes();
+        Frustum frustum = Frustum::fromMatrix(viewProj);
+        occlusion.begin(viewProj);
+        drawChunkOccluders(occlusion, eye, frustum);
+        collectVisibleChunks(eye, 80.0f, visible, &frustum, &occlusion);
+        collectFragmentStores(stores);
+        buildFragmentInstances(stores, instances, batches, 0.5f, &frustum, &occlusion);
+        buildParticleInstances(instances, batches, 0.5f, &frustum);
+        frameArena.reset();
+    }
+    resetDebris();
+}
+
+// One physics step over `arg` awake fragments. The field is re-spawned when
+// enough of it has gone to sleep, so every step sees a mostly awake set.
+static void BM_updateAllFragments(BenchState& state) {
+    resetDebris();
+    spawnFragmentField((int)state.arg, 1234);
+    while (state.keepRunning()) {
+        updateAllFragments(1.0f / 60.0f);
+        if ((int64_t)fragments.size() * 2 < state.arg) {
+            state.pauseTiming();
+            resetDebris();
+            spawnFragmentField((int)state.arg, 1234);
+            state.resumeTiming();
+        }
+    }
+    state.items = state.done * state.arg;
+    resetDebris();
+}
+
+static void BM_findTarget(BenchState& state) {
+    ensureCity();
+    std::mt19937 g(3);
+    std::uniform_real_distribution<float> yaw(-3.14f, 3.14f), pitch(-0.8f, 0.8f);
+    std::uniform_int_distribution<int> block(0, (int)worldBlocks.size() - 1);
+    struct View { Vec3 pos; float yaw, pitch; };
+    std::vector<View> views(256);
+    for (auto& v : views) v = {worldBlocks[block(g)].position + Vec3{0, 1.5f, 0}, yaw(g), pitch(g)};
+    int hits = 0;
+    size_t k = 0;
+    while (state.keepRunning()) {
+        const View& v = views[k++ & 255];
+        playerPos = v.pos;
+        camYaw = v.yaw;
+        camPitch = v.pitch;
+        findTarget();
+        hits += hasTarget;
+    }
+    state.items = state.done;
+    state.label = std::to_string(hits * 100 / std::max<int64_t>(1, state.done)) + "% hit";
+}
+
+static void BM_raycastBatch(BenchState& state) {
+    ensureCity();
+    std::mt19937 g(5);
+    std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+    std::uniform_int_distribution<int> block(0, (int)worldBlocks.size() - 1);
+    std::vector<RayQuery> rays((size_t)state.arg);
+    std::vector<RayHit> hits(rays.size());
+    for (auto& r : rays) r = {worldBlocks[block(g)].position + Vec3{0, 1.5f, 0}, {d(g), d(g), d(g)}, 32.0f};
+    while (state.keepRunning())
+        raycastBatch(rays.data(), hits.data(), (int)rays.size());
+    state.items = state.done * state.arg;
+}
+
+// ---------------------------------------------------------------------------
+// Runner
+
+static void registerAllBenches() {
+    registerBench("BM_clipShapeByPlane", BM_clipShapeByPlane, {1, 4, 16});
+    registerBench("BM_fractureAndSpawn", BM_fractureAndSpawn, {1, 10, 100});
+    registerBench("BM_fractureProcedural", BM_fractureProcedural, {1, 10, 100});
+    registerBench("BM_genCubeOptimized", BM_genCubeOptimized);
+    registerBench("BM_chunkMeshRebuild", BM_chunkMeshRebuild, {MESH_CULLED, MESH_GREEDY});
+    registerBench("BM_frameRebuild", BM_frameRebuild, {0, 10000});
+    registerBench("BM_updateAllFragments", BM_updateAllFragments, {1000, 10000, 100000});
+    registerBench("BM_findTarget", BM_findTarget);
+    registerBench("BM_raycastBatch", BM_raycastBatch, {1024});
+}
+
+#ifdef USE_GOOGLE_BENCHMARK
+int main(int argc, char** argv) {
+    // --threads is ours; the rest goes to the library.
+    int threads = -1;
+    std::vector<char*> args;
+    for (int i = 0; i < argc; i++) {
+        if (!strncmp(argv[i], "--threads=", 10)) threads = atoi(argv[i] + 10);
+        else args.push_back(argv[i]);
+    }
+    int n = (int)args.size();
+    benchmark::Initialize(&n, args.data());
+    if (benchmark::ReportUnrecognizedArguments(n, args.data())) return 1;
+    initJobs(threads);
+    benchmark::AddCustomContext("job_workers", std::to_string(jobWorkerCount()));
+    registerAllBenches();
+    for (const MicroBench& b : microBenches()) {
+        void (*fn)(BenchState&) = b.fn;
+        bool hasArg = !b.args.empty();
+        benchmark::internal::Benchmark* gb = benchmark::RegisterBenchmark(b.name.c_str(), [fn, hasArg](benchmark::State& st) {
+            BenchState state(st, hasArg ? st.range(0) : 0);
+            fn(state);
+            if (state.items) st.SetItemsProcessed(state.items);
+            if (!state.label.empty()) st.SetLabel(state.label);
+        });
+        for (int64_t a : b.args) gb->Arg(a);
+        gb->UseRealTime();
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    resetDebris();
+    shutdownJobs();
+    return 0;
+}
+#else
+
+struct BenchResult {
+    std::string name, label;
+    int64_t iterations;
+    double realNs, cpuNs, itemsPerSec;
+};
+
+// Google Benchmark's name for the run, "/real_time" included.
+static std::string benchRunName(const MicroBench& b, int64_t arg, bool hasArg) {
+    return (hasArg ? b.name + "/" + std::to_string(arg) : b.name) + "/real_time";
+}
+
+static BenchResult runBench(const MicroBench& b, int64_t arg, bool hasArg, double minTime) {
+    int64_t iters = 1;
+    for (;;) {
+        BenchState state(iters, arg);
+        b.fn(state);
+        bool last = state.realSec >= minTime || iters >= 1000000000;
+        if (last) {
+            BenchResult r;
+            r.name = benchRunName(b, arg, hasArg);
+            r.label = state.label;
+            r.iterations = iters;
+            r.realNs = state.realSec * 1e9 / iters;
+            r.cpuNs = state.cpuSec * 1e9 / iters;
+            r.itemsPerSec = state.items && state.realSec > 0 ? state.items / state.realSec : 0;
+            return r;
+        }
+        // Same growth rule as Google Benchmark: aim 40% past the target,
+        // never more than 10x per round.
+        double scale = state.realSec > 0 ? minTime * 1.4 / state.realSec : 10.0;
+        iters = std::max(iters + 1, (int64_t)(iters * std::min(10.0, scale)));
+    }
+}
+
+static std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static void writeJson(FILE* f, const std::vector<BenchResult>& results, const char* exe) {
+    char date[64];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    fprintf(f, "{\n  \"context\": {\n");
+    fprintf(f, "    \"date\": \"%s\",\n", date);
+    fprintf(f, "    \"executable\": \"%s\",\n", jsonEscape(exe).c_str());
+    fprintf(f, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+    fprintf(f, "    \"job_workers\": %d,\n", jobWorkerCount());
+    fprintf(f, "    \"library_build_type\": \"release\"\n  },\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(f, "    {\n");
+        fprintf(f, "      \"name\": \"%s\",\n", jsonEscape(r.name).c_str());
+        fprintf(f, "      \"run_name\": \"%s\",\n", jsonEscape(r.name).c_str());
+        fprintf(f, "      \"run_type\": \"iteration\",\n");
+        fprintf(f, "      \"repetitions\": 1,\n      \"repetition_index\": 0,\n      \"threads\": 1,\n");
+        fprintf(f, "      \"iterations\": %lld,\n", (long long)r.iterations);
+        fprintf(f, "      \"real_time\": %.4f,\n", r.realNs);
+        fprintf(f, "      \"cpu_time\": %.4f,\n", r.cpuNs);
+        fprintf(f, "      \"time_unit\": \"ns\"");
+        if (r.itemsPerSec > 0) fprintf(f, ",\n      \"items_per_second\": %.4f", r.itemsPerSec);
+        if (!r.label.empty()) fprintf(f, ",\n      \"label\": \"%s\"", jsonEscape(r.label).c_str());
+        fprintf(f, "\n    }%s\n", i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+static void printConsoleLine(const BenchResult& r) {
+    printf("%-32s %14.0f ns %14.0f ns %12lld", r.name.c_str(), r.realNs, r.cpuNs, (long long)r.iterations);
+    if (r.itemsPerSec > 0) printf(" items/s=%.4g", r.itemsPerSec);
+    if (!r.label.empty()) printf(" %s", r.label.c_str());
+    printf("\n");
+    fflush(stdout);
+}
+
+static const char* flagValue(const char* arg, const char* name) {
+    size_t n = strlen(name);
+    return !strncmp(arg, name, n) && arg[n] == '=' ? arg + n + 1 : nullptr;
+}
+
+int main(int argc, char** argv) {
+    std::string filter = ".*";
+    double minTime = 0.5;
+    const char* outPath = nullptr;
+    bool json = false;
+    int threads = -1;
+    for (int i = 1; i < argc; i++) {
+        const char* v;
+        if ((v = flagValue(argv[i], "--benchmark_filter"))) filter = v;
+        else if ((v = flagValue(argv[i], "--benchmark_min_time"))) minTime = atof(v);
+        else if ((v = flagValue(argv[i], "--benchmark_out"))) outPath = v;
+        else if ((v = flagValue(argv[i], "--benchmark_format"))) json = !strcmp(v, "json");
+        else if ((v = flagValue(argv[i], "--threads"))) threads = atoi(v);
+        else { fprintf(stderr, "unknown flag %s\n", argv[i]); return 1; }
+    }
+    initJobs(threads);
+    registerAllBenches();
+
+    std::regex re(filter);
+    std::vector<BenchResult> results;
+    if (!json) printf("%-32s %17s %17s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+    for (const MicroBench& b : microBenches()) {
+        std::vector<int64_t> args = b.args.empty() ? std::vector<int64_t>{0} : b.args;
+        for (int64_t a : args) {
+            std::string name = benchRunName(b, a, !b.args.empty());
+            if (!std::regex_search(name, re)) continue;
+            results.push_back(runBench(b, a, !b.args.empty(), minTime));
+            if (!json) printConsoleLine(results.back());
+        }
+    }
+    if (json) writeJson(stdout, results, argv[0]);
+    if (outPath) {
+        FILE* f = fopen(outPath, "w");
+        if (!f) { fprintf(stderr, "cannot write %s\n", outPath); return 1; }
+        writeJson(f, results, argv[0]);
+        fclose(f);
+    }
+    resetDebris();
+    shutdownJobs();
+    return 0;
+}
+#endif
\ No newline at end of file
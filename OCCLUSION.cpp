@@ -0,0 +1,238 @@
+#pragma once
+
+// Software occlusion culling. A few large occluders (solid stretches of wall
+// and ground, see findChunkOccluders) are rasterised on the CPU into a small
+// depth buffer, and a max-depth pyramid built over it answers "is this box
+// hidden?" with a handful of reads, before anything is submitted to the GPU.
+//
+// Every step errs towards visible: an occluder only writes pixels it covers
+// completely, at the farthest depth it reaches inside them, and a box is only
+// hidden if its nearest point lies behind the farthest occluder depth over
+// every pixel its screen rectangle touches. Depth is Vulkan's z/w, 0 at the
+// near plane and 1 at the far one; the buffer clears to 1.
+//
+// Nothing here touches the world or the GPU, so TESTS.cpp drives it with
+// hand-made views and quads.
+
+// Small enough to fill quickly, large enough that a wall across a street still
+// covers whole pixels at the occluder distance.
+static const int OCC_WIDTH = 128, OCC_HEIGHT = 72;
+static const int OCC_LEVELS = 4;
+
+// A planar convex quad, corners in order around the edge.
+struct OccluderQuad {
+    Vec3 corner[4];
+};
+
+// A quad after clipping and projection: edge functions e = a*x + b*y + c,
+// positive inside, and its depth plane, over the pixel rectangle x0..x1,
+// y0..y1. A pixel counts only if e >= thr at its centre for every edge, i.e.
+// the whole pixel is inside.
+struct QuadRaster {
+    int n;
+    float ea[5], eb[5], ec[5], thr[5];
+    float dzdx, dzdy, z0, zMax;
+    int x0, x1, y0, y1;
+};
+
+struct OcclusionBuffer {
+    Mat4 viewProj;
+    int width[OCC_LEVELS], height[OCC_LEVELS], stride[OCC_LEVELS];
+    // Level 0 is the raster; each level above holds the max of 2x2 below.
+    std::vector<float> depth[OCC_LEVELS];
+    uint32_t quadsDrawn = 0;
+
+    OcclusionBuffer() {
+        int w = OCC_WIDTH, h = OCC_HEIGHT;
+        for (int l = 0; l < OCC_LEVELS; l++) {
+            width[l] = w;
+            height[l] = h;
+            // Rows padded so a SIMD span that starts inside a row stays in it.
+            stride[l] = (w + 7) & ~7;
+            depth[l].assign((size_t)stride[l] * h, 1.0f);
+            w = (w + 1) / 2;
+            h = (h + 1) / 2;
+        }
+        viewProj = Mat4::identity();
+    }
+
+    void begin(const Mat4& vp) {
+        viewProj = vp;
+        std::fill(depth[0].begin(), depth[0].end(), 1.0f);
+        quadsDrawn = 0;
+    }
+
+    void toClip(Vec3 p, float out[4]) const {
+        const float* m = viewProj.m;
+        out[0] = m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12];
+        out[1] = m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13];
+        out[2] = m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14];
+        out[3] = m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15];
+    }
+
+    // Clips and projects q; false if nothing of it can cover a pixel.
+    bool setupQuad(const OccluderQuad& q, QuadRaster& r) const {
+        // Clip against the near plane (z >= 0); a quad gains at most one corner.
+        float in[4][4], poly[5][4];
+        for (int i = 0; i < 4; i++) toClip(q.corner[i], in[i]);
+        int n = 0;
+        for (int i = 0; i < 4; i++) {
+            const float* a = in[i];
+            const float* b = in[(i + 1) & 3];
+            if (a[2] >= 0) { memcpy(poly[n++], a, sizeof(float) * 4); }
+            if ((a[2] >= 0) != (b[2] >= 0)) {
+                float t = a[2] / (a[2] - b[2]);
+                for (int k = 0; k < 4; k++) poly[n][k] = a[k] + (b[k] - a[k]) * t;
+                n++;
+            }
+        }
+        if (n < 3) return false;
+
+        float sx[5], sy[5], sz[5];
+        for (int i = 0; i < n; i++) {
+            float inv = 1.0f / poly[i][3];
+            sx[i] = (poly[i][0] * inv * 0.5f + 0.5f) * OCC_WIDTH;
+            sy[i] = (poly[i][1] * inv * 0.5f + 0.5f) * OCC_HEIGHT;
+            sz[i] = poly[i][2] * inv;
+        }
+
+        // Depth is affine in screen space across a plane; take its gradient
+        // from the widest corner triangle and give up on edge-on quads.
+        float area = 0;
+        for (int i = 0; i < n; i++) {
+            int j = (i + 1) % n;
+            area += sx[i] * sy[j] - sx[j] * sy[i];
+        }
+        if (fabsf(area) < 0.5f) return false;
+        int best = 1;
+        float bestDet = 0;
+        for (int i = 1; i + 1 < n; i++) {
+            float det = (sx[i] - sx[0]) * (sy[i + 1] - sy[0]) - (sx[i + 1] - sx[0]) * (sy[i] - sy[0]);
+            if (fabsf(det) > fabsf(bestDet)) { bestDet = det; best = i; }
+        }
+        float ux = sx[best] - sx[0], uy = sy[best] - sy[0], uz = sz[best] - sz[0];
+        float vx = sx[best + 1] - sx[0], vy = sy[best + 1] - sy[0], vz = sz[best + 1] - sz[0];
+        r.dzdx = (uz * vy - vz * uy) / bestDet;
+        r.dzdy = (vz * ux - uz * vx) / bestDet;
+        // Farthest depth the plane reaches inside a pixel, relative to its centre.
+        float slack = 0.5f * (fabsf(r.dzdx) + fabsf(r.dzdy));
+        r.zMax = 0;
+        for (int i = 0; i < n; i++) r.zMax = std::max(r.zMax, sz[i]);
+        r.z0 = sz[0] - r.dzdx * sx[0] - r.dzdy * sy[0] + slack;
+
+        r.n = n;
+        float sign = area > 0 ? 1.0f : -1.0f;
+        float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f;
+        for (int i = 0; i < n; i++) {
+            int j = (i + 1) % n;
+            float dx = sx[j] - sx[i], dy = sy[j] - sy[i];
+            r.ea[i] = -dy * sign;
+            r.eb[i] = dx * sign;
+            r.ec[i] = (dy * sx[i] - dx * sy[i]) * sign;
+            r.thr[i] = 0.5f * (fabsf(r.ea[i]) + fabsf(r.eb[i]));
+            minX = std::min(minX, sx[i]); maxX = std::max(maxX, sx[i]);
+            minY = std::min(minY, sy[i]); maxY = std::max(maxY, sy[i]);
+        }
+        r.x0 = std::max(0, (int)floorf(minX)); r.x1 = std::min(OCC_WIDTH - 1, (int)ceilf(maxX));
+        r.y0 = std::max(0, (int)floorf(minY)); r.y1 = std::min(OCC_HEIGHT - 1, (int)ceilf(maxY));
+        return r.x0 <= r.x1 && r.y0 <= r.y1;
+    }
+
+    // Reference fill, one pixel at a time. fillQuad must write exactly the
+    // same depths; the sums are grouped the same way so they round alike.
+    void fillQuadScalar(const QuadRaster& r) {
+        for (int y = r.y0; y <= r.y1; y++) {
+            float* row = depth[0].data() + (size_t)y * stride[0];
+            float cy = y + 0.5f;
+            for (int x = r.x0; x <= r.x1; x++) {
+                float cx = x + 0.5f;
+                bool inside = true;
+                for (int i = 0; i < r.n && inside; i++) inside = r.thr[i] <= r.ea[i] * cx + (r.eb[i] * cy + r.ec[i]);
+                if (!inside) continue;
+                float z = std::min(r.dzdx * cx + (r.dzdy * cy + r.z0), r.zMax);
+                row[x] = std::min(row[x], z);
+            }
+        }
+    }
+
+    void fillQuad(const QuadRaster& r) {
+#if defined(__SSE2__)
+        alignas(32) float lane[8] = {0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f};
+        simdf laneX = simdLoad(lane);
+        for (int y = r.y0; y <= r.y1; y++) {
+            float* row = depth[0].data() + (size_t)y * stride[0];
+            float cy = y + 0.5f;
+            for (int x = r.x0 & ~(SIMD_WIDTH - 1); x <= r.x1; x += SIMD_WIDTH) {
+                simdf cx = simdAdd(simdSet((float)x), laneX);
+                simdf inside = simdLessEq(simdSet(r.thr[0]), simdAdd(simdMul(simdSet(r.ea[0]), cx), simdSet(r.eb[0] * cy + r.ec[0])));
+                for (int i = 1; i < r.n; i++)
+                    inside = simdAnd(inside, simdLessEq(simdSet(r.thr[i]), simdAdd(simdMul(simdSet(r.ea[i]), cx), simdSet(r.eb[i] * cy + r.ec[i]))));
+                if (!simdMask(inside)) continue;
+                simdf z = simdMin(simdAdd(simdMul(simdSet(r.dzdx), cx), simdSet(r.dzdy * cy + r.z0)), simdSet(r.zMax));
+                simdf old = simdLoad(row + x);
+                simdStore(row + x, simdSelect(inside, simdMin(old, z), old));
+            }
+        }
+#else
+        fillQuadScalar(r);
+#endif
+    }
+
+    void drawQuad(const OccluderQuad& q) {
+        QuadRaster r;
+        if (!setupQuad(q, r)) return;
+        quadsDrawn++;
+        fillQuad(r);
+    }
+
+    void buildHiZ() {
+        for (int l = 1; l < OCC_LEVELS; l++) {
+            const float* src = depth[l - 1].data();
+            float* dst = depth[l].data();
+            int sw = width[l - 1], sh = height[l - 1], ss = stride[l - 1];
+            for (int y = 0; y < height[l]; y++) {
+                int ya = 2 * y, yb = std::min(2 * y + 1, sh - 1);
+                for (int x = 0; x < width[l]; x++) {
+                    int xa = 2 * x, xb = std::min(2 * x + 1, sw - 1);
+                    dst[y * stride[l] + x] = std::max(std::max(src[ya * ss + xa], src[ya * ss + xb]),
+                                                      std::max(src[yb * ss + xa], src[yb * ss + xb]));
+                }
+            }
+        }
+    }
+
+    // False only if the box is certainly hidden behind what has been drawn.
+    // Call buildHiZ() after the last drawQuad().
+    bool boxVisible(Vec3 mn, Vec3 mx) const {
+        float minX = 1e30f, maxX = -1e30f, minY = 1e30f, maxY = -1e30f, nearZ = 1e30f;
+        for (int i = 0; i < 8; i++) {
+            Vec3 p = {(i & 1) ? mx.x : mn.x, (i & 2) ? mx.y : mn.y, (i & 4) ? mx.z : mn.z};
+            float c[4];
+            toClip(p, c);
+            if (c[2] < 0) return true;  // crosses the near plane
+            float inv = 1.0f / c[3];
+            float x = (c[0] * inv * 0.5f + 0.5f) * OCC_WIDTH, y = (c[1] * inv * 0.5f + 0.5f) * OCC_HEIGHT;
+            minX = std::min(minX, x); maxX = std::max(maxX, x);
+            minY = std::min(minY, y); maxY = std::max(maxY, y);
+            nearZ = std::min(nearZ, c[2] * inv);
+        }
+        if (maxX < 0 || maxY < 0 || minX >= OCC_WIDTH || minY >= OCC_HEIGHT) return true;
+        int x0 = std::max(0, (int)floorf(minX)), x1 = std::min(OCC_WIDTH - 1, (int)floorf(maxX));
+        int y0 = std::max(0, (int)floorf(minY)), y1 = std::min(OCC_HEIGHT - 1, (int)floorf(maxY));
+        // Coarsest level at which the rectangle still spans few texels.
+        int l = 0;
+        while (l + 1 < OCC_LEVELS && (x1 - x0 > 3 || y1 - y0 > 3)) {
+            x0 >>= 1; x1 >>= 1; y0 >>= 1; y1 >>= 1;
+            l++;
+        }
+        const float* d = depth[l].data();
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++)
+                if (nearZ <= d[y * stride[l] + x]) return true;
+        return false;
+    }
+
+    bool sphereVisible(Vec3 c, float r) const {
+        return boxVisible({c.x - r, c.y - r, c.z - r}, {c.x + r, c.y + r, c.z + r});
+    }
+};
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+
+// The few OS calls the simulation core needs: mapping a file read-only,
+// replacing a file and making a directory. WORLD_SNAPSHOT.cpp declares them;
+// every entry point includes this file after SIM_CORE.cpp, so no OS header
+// (or its macros) ever reaches the core. threadCpuSeconds is for the
+// microbenchmark runner.
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#undef near
+#undef far
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+
+static bool mapFileReadOnly(const char* path, MappedFile& m) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(file, &sz) || sz.QuadPart == 0) { CloseHandle(file); return false; }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) { CloseHandle(file); return false; }
+    const void* p = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!p) { CloseHandle(mapping); CloseHandle(file); return false; }
+    m.file = file;
+    m.mapping = mapping;
+    m.data = (const uint8_t*)p;
+    m.size = (size_t)sz.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return false; }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    m.data = (const uint8_t*)p;
+    m.size = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+static void unmapFile(MappedFile& m) {
+    if (!m.data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(m.data);
+    CloseHandle((HANDLE)m.mapping);
+    CloseHandle((HANDLE)m.file);
+#else
+    munmap((void*)m.data, m.size);
+#endif
+    m = MappedFile();
+}
+
+// Moves `from` over `to`, replacing it in one step.
+static bool replaceFile(const char* from, const char* to) {
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(from, to) == 0;
+#endif
+}
+
+// Creates `path` if it does not exist yet.
+static void makeDirectory(const char* path) {
+#ifdef _WIN32
+    CreateDirectoryA(path, nullptr);
+#else
+    mkdir(path, 0755);
+#endif
+}
+
+// CPU time used by the calling thread alone, in seconds.
+static double threadCpuSeconds() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &created, &exited, &kernel, &user)) return 0;
+    uint64_t k = ((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+    uint64_t u = ((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+    return (double)(k + u) * 1e-7;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
\ No newline at end of file
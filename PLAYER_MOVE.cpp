@@ -0,0 +1,117 @@
+#pragma once
+
+static const float PLAYER_STEP_HEIGHT = 1.0f;
+// Off by default: with it on, PLAYER_STEP_HEIGHT walks the player up every
+// one-block wall, so only jumping and two-block walls still stop them.
+static bool playerStepUp = false;
+static const float PLAYER_MAX_FALL_SPEED = 50.0f;
+static const float SWEEP_SKIN = 1e-4f;
+
+// Swept AABB movement against the block grid. Each axis is swept on its own
+// (y, then x, then z): the box is pushed through the cell slices ahead of it
+// and stops at the first solid one, so the time of impact is exact however
+// far it moves in one step and the work is bounded by the cells it crosses.
+// Clipping one axis leaves the others free, which is what makes the player
+// slide along walls and floors.
+struct MoveResult {
+    bool hitX, hitY, hitZ;
+    bool grounded;
+    bool stepped;
+};
+
+static void playerBounds(Vec3 pos, float mn[3], float mx[3]) {
+    mn[0] = pos.x - PLAYER_RADIUS; mx[0] = pos.x + PLAYER_RADIUS;
+    mn[1] = pos.y;                 mx[1] = pos.y + PLAYER_HEIGHT;
+    mn[2] = pos.z - PLAYER_RADIUS; mx[2] = pos.z + PLAYER_RADIUS;
+}
+
+// True when any cell in slice `c` along `axis` that overlaps the box on the
+// two other axes holds a live block.
+static bool sliceBlocked(GridCursor& cursor, const float mn[3], const float mx[3], int axis, int c) {
+    int u = (axis + 1) % 3, v = (axis + 2) % 3;
+    int u0 = (int)floorf(mn[u] - 0.5f) + 1, u1 = (int)ceilf(mx[u] + 0.5f) - 1;
+    int v0 = (int)floorf(mn[v] - 0.5f) + 1, v1 = (int)ceilf(mx[v] + 0.5f) - 1;
+    int cell[3];
+    cell[axis] = c;
+    for (int i = u0; i <= u1; i++) {
+        cell[u] = i;
+        for (int j = v0; j <= v1; j++) {
+            cell[v] = j;
+            int idx = cursor.get(cell[0], cell[1], cell[2]);
+            if (idx >= 0 && worldBlocks[idx].active) return true;
+        }
+    }
+    return false;
+}
+
+// Moves the box along one axis by up to `delta` and returns the distance
+// actually travelled. Cells the box already overlaps are ignored so a player
+// who ends up inside a block can still walk out of it.
+static float sweepAxis(GridCursor& cursor, float mn[3], float mx[3], int axis, float delta) {
+    if (delta > 0) {
+        float lead = mx[axis];
+        for (int c = (int)ceilf(lead + 0.5f - SWEEP_SKIN); c - 0.5f < lead + delta; c++) {
+            if (sliceBlocked(cursor, mn, mx, axis, c)) {
+                delta = std::max(0.0f, c - 0.5f - lead - SWEEP_SKIN);
+                break;
+            }
+        }
+    } else if (delta < 0) {
+        float lead = mn[axis];
+        for (int c = (int)floorf(lead - 0.5f + SWEEP_SKIN); c + 0.5f > lead + delta; c--) {
+            if (sliceBlocked(cursor, mn, mx, axis, c)) {
+                delta = std::min(0.0f, c + 0.5f - lead + SWEEP_SKIN);
+                break;
+            }
+        }
+    }
+    mn[axis] += delta;
+    mx[axis] += delta;
+    return delta;
+}
+
+static void sweepXZ(GridCursor& cursor, float mn[3], float mx[3], float dx, float dz, MoveResult& res) {
+    res.hitX = sweepAxis(cursor, mn, mx, 0, dx) != dx;
+    res.hitZ = sweepAxis(cursor, mn, mx, 2, dz) != dz;
+}
+
+// Moves the player box from `pos` by `delta`. When `stepHeight` is positive and
+// a grounded move is blocked sideways, the move is retried lifted by up to
+// that height and then dropped back down; the lifted result is kept when it
+// gets further horizontally.
+static MoveResult movePlayer(Vec3& pos, Vec3 delta, bool wasGrounded, float stepHeight) {
+    MoveResult res = {};
+    if (!blockGrid) { pos += delta; return res; }
+    GridCursor cursor(*blockGrid);
+    float mn[3], mx[3];
+    playerBounds(pos, mn, mx);
+    float startMn[3] = {mn[0], mn[1], mn[2]}, startMx[3] = {mx[0], mx[1], mx[2]};
+
+    res.hitY = sweepAxis(cursor, mn, mx, 1, delta.y) != delta.y;
+    res.grounded = res.hitY && delta.y < 0;
+    sweepXZ(cursor, mn, mx, delta.x, delta.z, res);
+
+    if (stepHeight > 0 && (res.hitX || res.hitZ) && (wasGrounded || res.grounded)) {
+        float smn[3] = {startMn[0], startMn[1], startMn[2]};
+        float smx[3] = {startMx[0], startMx[1], startMx[2]};
+        MoveResult step = res;
+        float lift = sweepAxis(cursor, smn, smx, 1, stepHeight);
+        sweepXZ(cursor, smn, smx, delta.x, delta.z, step);
+        float drop = std::min(delta.y, 0.0f) - lift;
+        bool landed = sweepAxis(cursor, smn, smx, 1, drop) != drop;
+        float flat = (mn[0]-startMn[0])*(mn[0]-startMn[0]) + (mn[2]-startMn[2])*(mn[2]-startMn[2]);
+        float lifted = (smn[0]-startMn[0])*(smn[0]-startMn[0]) + (smn[2]-startMn[2])*(smn[2]-startMn[2]);
+        if (lifted > flat + 1e-6f) {
+            for (int a = 0; a < 3; a++) { mn[a] = smn[a]; mx[a] = smx[a]; }
+            res.hitX = step.hitX;
+            res.hitZ = step.hitZ;
+            // Lifted over a gap, the drop may not reach the ground.
+            res.hitY = landed;
+            res.grounded = landed;
+            res.stepped = true;
+        }
+    }
+
+    pos = {mn[0] + PLAYER_RADIUS, mn[1], mn[2] + PLAYER_RADIUS};
+    return res;
+}
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+// Voxel raycasts against the block grid using Amanatides-Woo traversal: the
+// ray steps from cell boundary to cell boundary, so it visits exactly the
+// cells it passes through and cannot skip a grazing hit. Blocks are unit
+// cubes centred on integer coordinates.
+struct RayHit {
+    int block;
+    float t;
+    int x, y, z;
+    Vec3 normal;
+    Vec3 point;
+};
+
+struct RayQuery {
+    Vec3 origin, dir;
+    float maxDist;
+};
+
+// `dir` need not be normalised; t and maxDist are in world units along it.
+// A ray starting inside a block hits it at t = 0 with a zero normal.
+static bool raycastBlocks(Vec3 origin, Vec3 dir, float maxDist, RayHit& hit) {
+    hit.block = -1;
+    hit.t = maxDist;
+    hit.normal = {0, 0, 0};
+    float len = dir.length();
+    if (!blockGrid || len < 1e-8f) return false;
+    dir = dir * (1.0f / len);
+
+    Vec3 o = {origin.x + 0.5f, origin.y + 0.5f, origin.z + 0.5f};
+    int x = (int)floorf(o.x), y = (int)floorf(o.y), z = (int)floorf(o.z);
+    int stepX = dir.x > 0 ? 1 : (dir.x < 0 ? -1 : 0);
+    int stepY = dir.y > 0 ? 1 : (dir.y < 0 ? -1 : 0);
+    int stepZ = dir.z > 0 ? 1 : (dir.z < 0 ? -1 : 0);
+    const float inf = 1e30f;
+    float deltaX = stepX ? fabsf(1.0f / dir.x) : inf;
+    float deltaY = stepY ? fabsf(1.0f / dir.y) : inf;
+    float deltaZ = stepZ ? fabsf(1.0f / dir.z) : inf;
+    float nextX = stepX > 0 ? (x + 1 - o.x) * deltaX : (stepX < 0 ? (o.x - x) * deltaX : inf);
+    float nextY = stepY > 0 ? (y + 1 - o.y) * deltaY : (stepY < 0 ? (o.y - y) * deltaY : inf);
+    float nextZ = stepZ > 0 ? (z + 1 - o.z) * deltaZ : (stepZ < 0 ? (o.z - z) * deltaZ : inf);
+
+    GridCursor cursor(*blockGrid);
+    Vec3 normal = {0, 0, 0};
+    float t = 0;
+    while (t <= maxDist) {
+        int idx = cursor.get(x, y, z);
+        if (idx >= 0 && worldBlocks[idx].active) {
+            hit.block = idx;
+            hit.t = t;
+            hit.x = x; hit.y = y; hit.z = z;
+            hit.normal = normal;
+            hit.point = origin + dir * t;
+            return true;
+        }
+        if (nextX < nextY && nextX < nextZ) {
+            x += stepX; t = nextX; nextX += deltaX; normal = {(float)-stepX, 0, 0};
+        } else if (nextY < nextZ) {
+            y += stepY; t = nextY; nextY += deltaY; normal = {0, (float)-stepY, 0};
+        } else {
+            z += stepZ; t = nextZ; nextZ += deltaZ; normal = {0, 0, (float)-stepZ};
+        }
+    }
+    return false;
+}
+
+// Many independent rays (AI sight, explosion rays, ...) spread over the job
+// system. hits[i].block is -1 for a miss.
+static void raycastBatch(const RayQuery* rays, RayHit* hits, int count) {
+    parallelFor(count, 64, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+            raycastBlocks(rays[i].origin, rays[i].dir, rays[i].maxDist, hits[i]);
+    });
+}
+
+static bool lineOfSight(Vec3 from, Vec3 to) {
+    RayHit hit;
+    return !raycastBlocks(from, to - from, (to - from).length(), hit);
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+static VkInstance vkInst;
+static VkPhysicalDevice physDev;
+static VkDevice dev;
+static VkQueue gfxQueue, presQueue;
+static uint32_t gfxFam, presFam;
+static VkSurfaceKHR surf;
+static VkSwapchainKHR swapchain;
+static std::vector<VkImage> swapImgs;
+static std::vector<VkImageView> swapViews;
+static VkFormat swapFmt;
+static VkExtent2D swapExt;
+static VkRenderPass rpass;
+static VkPipelineLayout pipLayout;
+static VkDescriptorSetLayout descLayout;
+static VkDescriptorPool descPool;
+static VkDescriptorSet lightSet;
+static VkBuffer lightBuf=VK_NULL_HANDLE;
+static VkDeviceMemory lightMem;
+static VkPipeline pipeline;
+static VkPipeline instPipeline;
+static std::vector<VkFramebuffer> fbufs;
+static VkCommandPool cmdPool;
+static VkImage depImg;
+static VkDeviceMemory depMem;
+static VkImageView depView;
+static std::vector<Vertex> allVerts;
+static std::vector<uint32_t> allInds;
+static bool dirty=true;
+static bool keys[256]={};
+static bool mouseLocked=true;
+static bool lmbDown=false;
+static HWND hwnd;
+static int winW=1280, winH=720;
+static bool running=true;
+static POINT lastMouse;
\ No newline at end of file
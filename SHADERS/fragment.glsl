@@ -4,17 +4,31 @@ layout(location = 0) in vec3 fragColor;
 layout(location = 1) in vec3 fragNormal;
 layout(location = 2) in vec3 fragWorldPos;
 
+layout(push_constant) uniform PC {
+    mat4 mvp;
+    vec3 eye;
+} pc;
+
+// Mirrors LightUniforms in GRAPHICS.cpp.
+layout(set = 0, binding = 0) uniform LightBlock {
+    vec4 sunDir;        // xyz direction, w intensity
+    vec4 sunColor;      // rgb, w ambient intensity
+    vec4 ambientColor;
+    vec4 fogColor;      // rgb, w fog start
+    vec4 fogEnd;        // x fog end
+} light;
+
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    vec3 sunDir = normalize(vec3(-0.4, -0.7, -0.5));
-    vec3 sunColor = vec3(1.0, 0.9, 0.75);
-    float sunIntensity = 1.2;
-    vec3 ambientColor = vec3(0.4, 0.45, 0.55);
-    float ambientIntensity = 0.25;
-    vec3 fogColor = vec3(0.35, 0.38, 0.42);
-    float fogStart = 30.0;
-    float fogEnd = 150.0;
+    vec3 sunDir = normalize(light.sunDir.xyz);
+    vec3 sunColor = light.sunColor.rgb;
+    float sunIntensity = light.sunDir.w;
+    vec3 ambientColor = light.ambientColor.rgb;
+    float ambientIntensity = light.sunColor.w;
+    vec3 fogColor = light.fogColor.rgb;
+    float fogStart = light.fogColor.w;
+    float fogEnd = light.fogEnd.x;
 
     vec3 N = normalize(fragNormal);
 
@@ -44,7 +58,7 @@ void main() {
     float gamma = 1.0 / 2.2;
     result = pow(result, vec3(gamma));
 
-    float dist = length(fragWorldPos);
+    float dist = length(fragWorldPos - pc.eye);
     float fogFactor = clamp((dist - fogStart) / (fogEnd - fogStart), 0.0, 1.0);
     fogFactor = fogFactor * fogFactor;
     result = mix(result, fogColor, fogFactor);
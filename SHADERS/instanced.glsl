@@ -0,0 +1,36 @@
+#version 450
+
+layout(location = 0) in vec3 inPos;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec3 inColor;
+
+layout(location = 3) in vec3 instPos;
+layout(location = 4) in vec3 instRot;
+layout(location = 5) in vec3 instScale;
+layout(location = 6) in vec3 instTint;
+
+layout(push_constant) uniform PC {
+    mat4 mvp;
+    vec3 eye;
+} pc;
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec3 fragNormal;
+layout(location = 2) out vec3 fragWorldPos;
+
+// Same X, then Y, then Z order the CPU used for fragments.
+vec3 rotateXYZ(vec3 p, vec3 r) {
+    vec3 c = cos(r), s = sin(r);
+    p = vec3(p.x, p.y * c.x - p.z * s.x, p.y * s.x + p.z * c.x);
+    p = vec3(p.x * c.y + p.z * s.y, p.y, -p.x * s.y + p.z * c.y);
+    p = vec3(p.x * c.z - p.y * s.z, p.x * s.z + p.y * c.z, p.z);
+    return p;
+}
+
+void main() {
+    vec3 world = rotateXYZ(inPos * instScale, instRot) + instPos;
+    gl_Position = pc.mvp * vec4(world, 1.0);
+    fragColor = inColor * instTint;
+    fragNormal = rotateXYZ(inNormal / instScale, instRot);
+    fragWorldPos = world;
+}
\ No newline at end of file
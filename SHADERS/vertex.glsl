@@ -6,6 +6,7 @@ layout(location = 2) in vec3 inColor;
 
 layout(push_constant) uniform PC {
     mat4 mvp;
+    vec3 eye;
 } pc;
 
 layout(location = 0) out vec3 fragColor;
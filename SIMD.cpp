@@ -0,0 +1,42 @@
+#pragma once
+
+// Thin float-lane wrappers so kernels are written once for AVX (8 lanes) or
+// SSE2 (4 lanes). Callers keep a scalar path for the tail and for builds with
+// neither.
+#if defined(__AVX__)
+typedef __m256 simdf;
+static const int SIMD_WIDTH = 8;
+static inline simdf simdSet(float v) { return _mm256_set1_ps(v); }
+static inline simdf simdLoad(const float* p) { return _mm256_loadu_ps(p); }
+static inline void simdStore(float* p, simdf v) { _mm256_storeu_ps(p, v); }
+static inline simdf simdAdd(simdf a, simdf b) { return _mm256_add_ps(a, b); }
+static inline simdf simdSub(simdf a, simdf b) { return _mm256_sub_ps(a, b); }
+static inline simdf simdMul(simdf a, simdf b) { return _mm256_mul_ps(a, b); }
+static inline simdf simdMin(simdf a, simdf b) { return _mm256_min_ps(a, b); }
+static inline simdf simdMax(simdf a, simdf b) { return _mm256_max_ps(a, b); }
+static inline simdf simdSqrt(simdf a) { return _mm256_sqrt_ps(a); }
+static inline simdf simdLess(simdf a, simdf b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static inline simdf simdLessEq(simdf a, simdf b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+static inline simdf simdAnd(simdf a, simdf b) { return _mm256_and_ps(a, b); }
+static inline simdf simdAndNot(simdf a, simdf b) { return _mm256_andnot_ps(a, b); }
+static inline simdf simdSelect(simdf mask, simdf a, simdf b) { return _mm256_blendv_ps(b, a, mask); }
+static inline int simdMask(simdf m) { return _mm256_movemask_ps(m); }
+#elif defined(__SSE2__)
+typedef __m128 simdf;
+static const int SIMD_WIDTH = 4;
+static inline simdf simdSet(float v) { return _mm_set1_ps(v); }
+static inline simdf simdLoad(const float* p) { return _mm_loadu_ps(p); }
+static inline void simdStore(float* p, simdf v) { _mm_storeu_ps(p, v); }
+static inline simdf simdAdd(simdf a, simdf b) { return _mm_add_ps(a, b); }
+static inline simdf simdSub(simdf a, simdf b) { return _mm_sub_ps(a, b); }
+static inline simdf simdMul(simdf a, simdf b) { return _mm_mul_ps(a, b); }
+static inline simdf simdMin(simdf a, simdf b) { return _mm_min_ps(a, b); }
+static inline simdf simdMax(simdf a, simdf b) { return _mm_max_ps(a, b); }
+static inline simdf simdSqrt(simdf a) { return _mm_sqrt_ps(a); }
+static inline simdf simdLess(simdf a, simdf b) { return _mm_cmplt_ps(a, b); }
+static inline simdf simdLessEq(simdf a, simdf b) { return _mm_cmple_ps(a, b); }
+static inline simdf simdAnd(simdf a, simdf b) { return _mm_and_ps(a, b); }
+static inline simdf simdAndNot(simdf a, simdf b) { return _mm_andnot_ps(a, b); }
+static inline simdf simdSelect(simdf mask, simdf a, simdf b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+static inline int simdMask(simdf m) { return _mm_movemask_ps(m); }
+#endif
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+static Vec3 getCamForward() {
+    return {cosf(camPitch)*sinf(camYaw),-sinf(camPitch),cosf(camPitch)*cosf(camYaw)};
+}
+
+static Vec3 getCamRight() {
+    Vec3 fwd=getCamForward();
+    Vec3 up={0,1,0};
+    return Vec3::cross(fwd,up).normalized();
+}
+
+static Vec3 getEyePos() { return {playerPos.x,playerPos.y+PLAYER_EYE,playerPos.z}; }
+static Vec3 getRenderEyePos() { Vec3 p=prevPlayerPos+(playerPos-prevPlayerPos)*renderAlpha; return {p.x,p.y+PLAYER_EYE,p.z}; }
+
+// View-projection of the camera at `eye`; the renderer draws with it and
+// culls against its frustum.
+static Mat4 cameraViewProj(Vec3 eye, float aspect) {
+    Mat4 view=Mat4::lookAt(eye,eye+getCamForward(),{0,1,0});
+    Mat4 proj=Mat4::perspective(PI/3.0f,aspect,0.05f,500.0f);
+    return proj*view;
+}
+static void findTarget() {
+    RayHit hit;
+    hasTarget = raycastBlocks(getEyePos(), getCamForward(), REACH_DIST, hit);
+    targetBlockIdx = hit.block;
+    targetNormal = hit.normal;
+}
+
+// Movement intent for one tick, in camera-relative axes (each -1..1).
+struct SimInput { float forward, strafe; bool jump; };
+
+static void stepPlayer(const SimInput& in, float dt) {
+    prevPlayerPos=playerPos;
+    Vec3 fwd=getCamForward(), right=getCamRight();
+    Vec3 flatFwd={fwd.x,0,fwd.z}; flatFwd=flatFwd.normalized();
+    Vec3 flatRight={right.x,0,right.z}; flatRight=flatRight.normalized();
+    Vec3 moveDir=flatFwd*in.forward+flatRight*in.strafe;
+    if(moveDir.lengthSq()>0.0001f) moveDir=moveDir.normalized();
+    playerVel.y=std::max(playerVel.y-GRAVITY*dt,-PLAYER_MAX_FALL_SPEED);
+    bool jumped=in.jump&&onGround;
+    if(jumped) playerVel.y=JUMP_SPEED;
+    Vec3 delta={moveDir.x*MOVE_SPEED*dt,playerVel.y*dt,moveDir.z*MOVE_SPEED*dt};
+    MoveResult mv=movePlayer(playerPos,delta,onGround&&!jumped,playerStepUp?PLAYER_STEP_HEIGHT:0.0f);
+    if(mv.hitY) playerVel.y=0;
+    onGround=mv.grounded;
+    if(playerPos.y<0) { playerPos.y=0; playerVel.y=0; onGround=true; }
+}
+
+// One fixed simulation tick; dt is always 1/simTickHz.
+static void simTick(const SimInput& in, float dt) {
+    stepPlayer(in,dt);
+    updateWorldPaging(playerPos);
+    updateStreaming(playerPos);
+    publishFractureJobs();
+    updateAllFragments(dt);
+    updateParticles(dt);
+}
+
+// Fixed-step accumulator: runs as many ticks as the elapsed time covers, up to
+// maxTicksPerFrame. Time beyond that is dropped, so under load the simulation
+// slows down instead of spiralling. What is left blends the last two ticks.
+static void tickSimulation(double& acc, const SimInput& in) {
+    double step=1.0/simTickHz; int n=0;
+    while(acc>=step&&n<maxTicksPerFrame) { simTick(in,(float)step); acc-=step; n++; }
+    if(acc>=step) { uint64_t drop=(uint64_t)(acc/step); simTicksDropped+=drop; acc-=drop*step; }
+    simTicksLastFrame=n; renderAlpha=(float)(acc/step);
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+// Everything the simulation needs, with no window, GPU or OS dependency.
+// MAIN.cpp gets it through IMPORT_ALL.cpp; BENCH.cpp includes it directly.
+// Each entry point also includes PLATFORM.cpp after it, for the file calls
+// WORLD_SNAPSHOT.cpp declares.
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <cstdint>
+#include <climits>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include "TYPES.cpp"
+#include "ARENA.cpp"
+#include "SIMD.cpp"
+#include "FRUSTUM.cpp"
+#include "OCCLUSION.cpp"
+#include "ALLOPTIMIZER.cpp"
+#include "CHUNK_MESH.cpp"
+#include "MESH_LIBRARY.cpp"
+#include "JOBS.cpp"
+#include "SPATIAL_HASH.cpp"
+#include "RAYCAST.cpp"
+#include "PLAYER_MOVE.cpp"
+#include "BLOCK_PHYSICS.cpp"
+#include "BLOCK_PARTICLES.cpp"
+#include "BLOCK_FRACTURE.cpp"
+#include "BLOCK_DELETE.cpp"
+#include "WORLD_GEN.cpp"
+#include "WORLD_SNAPSHOT.cpp"
+#include "WORLD_STREAM.cpp"
+#include "SIMULATION.cpp"
\ No newline at end of file
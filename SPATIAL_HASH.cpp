@@ -0,0 +1,62 @@
+#pragma once
+
+// Uniform-grid spatial hash rebuilt from scratch each step. Bodies are bucketed
+// by the hash of their cell with a counting sort, so a build is two linear
+// passes and no per-cell allocation. Different cells can share a bucket; the
+// caller's distance test filters those out.
+struct SpatialHash {
+    float invCell = 1.0f;
+    uint32_t mask = 0;
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> entries;
+    std::vector<uint32_t> bucketOf;
+
+    int cellCoord(float v) const { return (int)floorf(v * invCell); }
+
+    uint32_t bucket(int cx, int cy, int cz) const {
+        uint32_t h = (uint32_t)cx * 73856093u ^ (uint32_t)cy * 19349663u ^ (uint32_t)cz * 83492791u;
+        return h & mask;
+    }
+
+    void build(const float* x, const float* y, const float* z, uint32_t n, float cellSize) {
+        invCell = 1.0f / cellSize;
+        uint32_t tableSize = 64;
+        while (tableSize < n * 2) tableSize <<= 1;
+        mask = tableSize - 1;
+        cellStart.assign(tableSize + 1, 0);
+        bucketOf.resize(n);
+        entries.resize(n);
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t b = bucket(cellCoord(x[i]), cellCoord(y[i]), cellCoord(z[i]));
+            bucketOf[i] = b;
+            cellStart[b + 1]++;
+        }
+        for (uint32_t b = 0; b < tableSize; b++) cellStart[b + 1] += cellStart[b];
+        std::vector<uint32_t>& fill = scratch;
+        fill.assign(cellStart.begin(), cellStart.end() - 1);
+        for (uint32_t i = 0; i < n; i++) entries[fill[bucketOf[i]]++] = i;
+    }
+
+    // Calls fn(j) for every body in the 27 cells around (x, y, z). A bucket
+    // reached from two cells is only visited once.
+    template <typename F>
+    void query(float x, float y, float z, F fn) const {
+        if (entries.empty()) return;
+        int cx = cellCoord(x), cy = cellCoord(y), cz = cellCoord(z);
+        uint32_t seen[27];
+        int count = 0;
+        for (int dx = -1; dx <= 1; dx++)
+            for (int dy = -1; dy <= 1; dy++)
+                for (int dz = -1; dz <= 1; dz++) {
+                    uint32_t b = bucket(cx + dx, cy + dy, cz + dz);
+                    bool dup = false;
+                    for (int k = 0; k < count; k++) if (seen[k] == b) { dup = true; break; }
+                    if (dup) continue;
+                    seen[count++] = b;
+                    for (uint32_t e = cellStart[b]; e < cellStart[b + 1]; e++) fn(entries[e]);
+                }
+    }
+
+private:
+    std::vector<uint32_t> scratch;
+};
\ No newline at end of file
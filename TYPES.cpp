@@ -43,16 +43,60 @@ struct Mat4 {
 };
 
 struct Vertex { Vec3 pos, normal, color; };
-struct PushConstants { Mat4 mvp; };
+struct InstanceData { Vec3 position, rotation, scale, tint; };
+struct PushConstants { Mat4 mvp; Vec3 eye; float pad; };
 
 struct Fragment {
     Vec3 position, velocity, rotation, rotSpeed, color, scale;
-    std::vector<Vertex> vertices;
-    std::vector<uint32_t> indices;
+    Vec3 tint={1,1,1};
+    int mesh;
     float lifetime, maxLifetime;
     bool eternal, active;
 };
 
+// Live fragments, one array per field so the physics step only streams the
+// data it touches. A Fragment is just the spawn description. ox..orz hold the
+// pose at the start of the last tick so rendering can interpolate.
+struct FragmentStore {
+    std::vector<float> px,py,pz, vx,vy,vz, rx,ry,rz, wx,wy,wz, ox,oy,oz, orx,ory,orz;
+    std::vector<float> sx,sy,sz, tr,tg,tb, extent, radius, life, maxLife, restTime, ax,ay,az;
+    std::vector<int> mesh;
+    std::vector<uint8_t> eternal, onGround, contact;
+    size_t size() const { return mesh.size(); }
+    bool empty() const { return mesh.empty(); }
+    void add(const Fragment& f) {
+        px.push_back(f.position.x); py.push_back(f.position.y); pz.push_back(f.position.z);
+        vx.push_back(f.velocity.x); vy.push_back(f.velocity.y); vz.push_back(f.velocity.z);
+        rx.push_back(f.rotation.x); ry.push_back(f.rotation.y); rz.push_back(f.rotation.z);
+        wx.push_back(f.rotSpeed.x); wy.push_back(f.rotSpeed.y); wz.push_back(f.rotSpeed.z);
+        sx.push_back(f.scale.x); sy.push_back(f.scale.y); sz.push_back(f.scale.z);
+        tr.push_back(f.tint.x); tg.push_back(f.tint.y); tb.push_back(f.tint.z);
+        extent.push_back((f.scale.x+f.scale.y+f.scale.z)/3.0f); radius.push_back(0);
+        life.push_back(f.lifetime); maxLife.push_back(f.maxLifetime); restTime.push_back(0);
+        ax.push_back(f.position.x); ay.push_back(f.position.y); az.push_back(f.position.z);
+        ox.push_back(f.position.x); oy.push_back(f.position.y); oz.push_back(f.position.z);
+        orx.push_back(f.rotation.x); ory.push_back(f.rotation.y); orz.push_back(f.rotation.z);
+        mesh.push_back(f.mesh); eternal.push_back(f.eternal); onGround.push_back(0); contact.push_back(0);
+    }
+    void append(const FragmentStore& o, size_t i) { resize(size()+1); copyFrom(size()-1,o,i); }
+    void copyFrom(size_t dst, const FragmentStore& o, size_t src) {
+        px[dst]=o.px[src]; py[dst]=o.py[src]; pz[dst]=o.pz[src]; vx[dst]=o.vx[src]; vy[dst]=o.vy[src]; vz[dst]=o.vz[src];
+        rx[dst]=o.rx[src]; ry[dst]=o.ry[src]; rz[dst]=o.rz[src]; wx[dst]=o.wx[src]; wy[dst]=o.wy[src]; wz[dst]=o.wz[src];
+        sx[dst]=o.sx[src]; sy[dst]=o.sy[src]; sz[dst]=o.sz[src]; tr[dst]=o.tr[src]; tg[dst]=o.tg[src]; tb[dst]=o.tb[src]; extent[dst]=o.extent[src]; radius[dst]=o.radius[src];
+        life[dst]=o.life[src]; maxLife[dst]=o.maxLife[src]; restTime[dst]=o.restTime[src];
+        ax[dst]=o.ax[src]; ay[dst]=o.ay[src]; az[dst]=o.az[src];
+        ox[dst]=o.ox[src]; oy[dst]=o.oy[src]; oz[dst]=o.oz[src]; orx[dst]=o.orx[src]; ory[dst]=o.ory[src]; orz[dst]=o.orz[src];
+        mesh[dst]=o.mesh[src]; eternal[dst]=o.eternal[src]; onGround[dst]=o.onGround[src]; contact[dst]=o.contact[src];
+    }
+    void move(size_t dst, size_t src) { copyFrom(dst,*this,src); }
+    void resize(size_t n) {
+        for(auto* v:{&px,&py,&pz,&vx,&vy,&vz,&rx,&ry,&rz,&wx,&wy,&wz,&sx,&sy,&sz,&tr,&tg,&tb,&extent,&radius,&life,&maxLife,&restTime,&ax,&ay,&az,&ox,&oy,&oz,&orx,&ory,&orz}) v->resize(n);
+        mesh.resize(n); eternal.resize(n); onGround.resize(n); contact.resize(n);
+    }
+    void clear() { resize(0); }
+    void settlePose(size_t i) { ox[i]=px[i]; oy[i]=py[i]; oz[i]=pz[i]; orx[i]=rx[i]; ory[i]=ry[i]; orz[i]=rz[i]; }
+};
+
 struct Block {
     Vec3 position, color;
     bool active;
@@ -66,51 +110,20 @@ static const float PLAYER_RADIUS=0.3f, GRAVITY=20.0f, JUMP_SPEED=8.0f;
 static const float MOVE_SPEED=6.0f, MOUSE_SENS=0.002f, REACH_DIST=8.0f, PI=3.14159265358979f;
 
 static std::vector<Block> worldBlocks;
-static std::vector<Fragment> fragments;
+static FragmentStore fragments;
 static std::mt19937 rng(42);
 
 static Vec3 playerPos={8.0f,20.0f,8.0f};
 static Vec3 playerVel={0,0,0};
+static Vec3 prevPlayerPos={0,0,0};
 static float camYaw=0, camPitch=0;
 static bool onGround=false;
-static bool keys[256]={};
-static bool mouseLocked=true;
-static bool lmbDown=false;
+static int simTickHz=60, maxTicksPerFrame=5;
+static float renderAlpha=1.0f;
+static int simTicksLastFrame=0;
+static uint64_t simTicksDropped=0;
 static bool fragmentsEternal=false;
 static float fragmentTimeout=10.0f;
 static int targetBlockIdx=-1;
 static bool hasTarget=false;
-
-static VkInstance vkInst;
-static VkPhysicalDevice physDev;
-static VkDevice dev;
-static VkQueue gfxQueue, presQueue;
-static uint32_t gfxFam, presFam;
-static VkSurfaceKHR surf;
-static VkSwapchainKHR swapchain;
-static std::vector<VkImage> swapImgs;
-static std::vector<VkImageView> swapViews;
-static VkFormat swapFmt;
-static VkExtent2D swapExt;
-static VkRenderPass rpass;
-static VkPipelineLayout pipLayout;
-static VkPipeline pipeline;
-static std::vector<VkFramebuffer> fbufs;
-static VkCommandPool cmdPool;
-static VkCommandBuffer cmdBuf;
-static VkSemaphore imgSem, renSem;
-static VkFence fence;
-static VkImage depImg;
-static VkDeviceMemory depMem;
-static VkImageView depView;
-static VkBuffer vBuf=VK_NULL_HANDLE;
-static VkDeviceMemory vMemory;
-static VkBuffer iBuf=VK_NULL_HANDLE;
-static VkDeviceMemory iMemory;
-static std::vector<Vertex> allVerts;
-static std::vector<uint32_t> allInds;
-static bool dirty=true;
-static HWND hwnd;
-static int winW=1280, winH=720;
-static bool running=true;
-static POINT lastMouse;
\ No newline at end of file
+static Vec3 targetNormal={0,0,0};
\ No newline at end of file
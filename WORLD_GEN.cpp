@@ -0,0 +1,202 @@
+#pragma once
+
+static void addBlock(std::vector<Block>& out, Vec3 pos, Vec3 col, int type=0) {
+    Block b; b.position=pos; b.color=col; b.active=true; b.type=type;
+    out.push_back(b);
+}
+
+static void addBlock(Vec3 pos, Vec3 col, int type=0) { addBlock(worldBlocks,pos,col,type); }
+
+static void generateStreet(std::vector<Block>& out, int startX, int startZ, int length, int dir, int width) {
+    Vec3 asphalt={0.15f,0.15f,0.17f};
+    Vec3 sidewalk={0.45f,0.43f,0.40f};
+    Vec3 curb={0.35f,0.33f,0.30f};
+    Vec3 yellowLine={0.7f,0.65f,0.1f};
+    for(int i=0;i<length;i++) {
+        for(int w=-width;w<=width;w++) {
+            int bx=startX, bz=startZ;
+            if(dir==0) { bx+=i; bz+=w; } else { bz+=i; bx+=w; }
+            Vec3 col=asphalt;
+            if(abs(w)==width) col=curb;
+            else if(abs(w)==width-1) col=sidewalk;
+            else if(w==0 && (i%4<2)) col=yellowLine;
+            if(abs(w)>=width-1) {
+                addBlock(out,{(float)bx,0,(float)bz},col,1);
+                addBlock(out,{(float)bx,1,(float)bz},sidewalk,1);
+            } else {
+                addBlock(out,{(float)bx,0,(float)bz},col,1);
+            }
+        }
+    }
+}
+
+static void generateBuilding(std::vector<Block>& out, std::mt19937& g, int bx, int bz, int w, int d, int h, Vec3 wallCol, Vec3 winCol, bool antenna) {
+    Vec3 frame={0.25f,0.22f,0.20f};
+    Vec3 roof={0.20f,0.18f,0.16f};
+    Vec3 trim={0.3f,0.28f,0.25f};
+    for(int x=0;x<w;x++) for(int z=0;z<d;z++) for(int y=2;y<h+2;y++) {
+        bool isEdge=(x==0||x==w-1||z==0||z==d-1);
+        bool isCorner=(x==0||x==w-1)&&(z==0||z==d-1);
+        bool isTop=(y==h+1);
+        if(!isEdge&&!isTop) continue;
+        Vec3 col=wallCol;
+        if(isCorner) col=frame;
+        else if(isTop) col=roof;
+        else if(isEdge&&!isCorner&&y>2) {
+            bool isWindowRow=(y-2)%3!=0;
+            bool isWindowCol;
+            if(x==0||x==w-1) isWindowCol=(z>0&&z<d-1&&(z%2==1));
+            else isWindowCol=(x>0&&x<w-1&&(x%2==1));
+            if(isWindowRow&&isWindowCol) {
+                std::uniform_real_distribution<float> lit(0.0f,1.0f);
+                if(lit(g)>0.4f) { float bright=0.6f+lit(g)*0.4f; col={winCol.x*bright,winCol.y*bright,winCol.z*bright}; }
+                else col={0.08f,0.1f,0.12f};
+            } else if((y-2)%3==0) col=trim;
+        }
+        addBlock(out,{(float)(bx+x),(float)y,(float)(bz+z)},col,2);
+    }
+    if(antenna) {
+        int ax=bx+w/2, az=bz+d/2;
+        for(int ay=h+2;ay<h+7;ay++) addBlock(out,{(float)ax,(float)ay,(float)az},{0.3f,0.3f,0.3f},3);
+        addBlock(out,{(float)ax,(float)(h+7),(float)az},{0.8f,0.1f,0.1f},3);
+    }
+}
+
+// Generation runs as independent tasks: ground tiles, street segments and
+// building lots. Each task knows the cells it can touch and draws from its own
+// RNG stream, derived from the map seed, its district and its index there, so
+// it produces the same blocks whenever and wherever it runs. A whole city
+// joins the task lists in order; a streamed column runs just the tasks that
+// reach into it. Either way a seed gives the same world on any thread count.
+struct GenTask {
+    int x0,z0,x1,z1;
+    uint32_t seed;
+    std::function<void(std::mt19937&,std::vector<Block>&)> run;
+};
+
+static const int CITY_DISTRICT=96, CITY_ORIGIN=-40, GEN_TILE=16;
+
+static uint32_t genStreamSeed(uint32_t seed, uint32_t stream) {
+    uint64_t x=((uint64_t)seed<<32|stream)+0x9E3779B97F4A7C15ull;
+    x=(x^(x>>30))*0xBF58476D1CE4E5B9ull; x=(x^(x>>27))*0x94D049BB133111EBull;
+    return (uint32_t)(x^(x>>31));
+}
+
+static uint32_t districtSeed(uint32_t seed, int dx, int dz) {
+    return genStreamSeed(genStreamSeed(seed,(uint32_t)dx),(uint32_t)dz);
+}
+
+static void runGenTasks(const std::vector<GenTask>& tasks) {
+    std::vector<std::vector<Block>> out(tasks.size());
+    parallelFor((int)tasks.size(),1,[&](int begin, int end) {
+        for(int i=begin;i<end;i++) { std::mt19937 g(tasks[i].seed); tasks[i].run(g,out[i]); }
+    });
+    std::vector<size_t> at(tasks.size()+1,0);
+    for(size_t i=0;i<tasks.size();i++) at[i+1]=at[i]+out[i].size();
+    worldBlocks.resize(at.back());
+    parallelFor((int)tasks.size(),8,[&](int begin, int end) {
+        for(int i=begin;i<end;i++) std::copy(out[i].begin(),out[i].end(),worldBlocks.begin()+at[i]);
+    });
+}
+
+// One City 17 layout, district (dx, dz) of an unbounded grid of them: ground,
+// three streets each way, a building on every lot and the tower. The lot plan
+// is drawn from the district's own stream up front, since where a lot goes
+// depends on the ones before it.
+static void planDistrict(uint32_t seed, int dx, int dz, std::vector<GenTask>& tasks) {
+    uint32_t dseed=districtSeed(seed,dx,dz);
+    uint32_t next=0;
+    int ox=dx*CITY_DISTRICT, oz=dz*CITY_DISTRICT;
+    auto add=[&](int x0, int z0, int x1, int z1, std::function<void(std::mt19937&,std::vector<Block>&)> fn) {
+        tasks.push_back({x0,z0,x1,z1,genStreamSeed(dseed,next++),std::move(fn)});
+    };
+
+    Vec3 ground={0.2f,0.22f,0.18f};
+    for(int tx=0;tx<CITY_DISTRICT;tx+=GEN_TILE) for(int tz=0;tz<CITY_DISTRICT;tz+=GEN_TILE) {
+        int x0=ox+CITY_ORIGIN+tx, z0=oz+CITY_ORIGIN+tz;
+        add(x0,z0,x0+GEN_TILE-1,z0+GEN_TILE-1,[=](std::mt19937&, std::vector<Block>& out) {
+            for(int x=x0;x<x0+GEN_TILE;x++) for(int z=z0;z<z0+GEN_TILE;z++) addBlock(out,{(float)x,-1,(float)z},ground,0);
+        });
+    }
+
+    int streetPositions[]={6,22,38}; int streetWidth=9;
+    for(int dir=0;dir<2;dir++) for(int sp:streetPositions) for(int i=0;i<CITY_DISTRICT;i+=GEN_TILE) {
+        int sx=dir==0?ox+CITY_ORIGIN+i:ox+sp, sz=dir==0?oz+sp:oz+CITY_ORIGIN+i;
+        int x0=dir==0?sx:sx-4, x1=dir==0?sx+GEN_TILE-1:sx+4, z0=dir==0?sz-4:sz, z1=dir==0?sz+4:sz+GEN_TILE-1;
+        add(x0,z0,x1,z1,[=](std::mt19937&, std::vector<Block>& out) { generateStreet(out,sx,sz,GEN_TILE,dir,4); });
+    }
+
+    Vec3 walls[]={{0.42f,0.38f,0.35f},{0.35f,0.32f,0.30f},{0.50f,0.45f,0.40f},{0.38f,0.35f,0.33f},{0.30f,0.28f,0.25f},{0.45f,0.40f,0.38f}};
+    Vec3 wins[]={{0.7f,0.65f,0.3f},{0.3f,0.5f,0.7f},{0.8f,0.7f,0.4f},{0.6f,0.7f,0.8f},{0.9f,0.8f,0.5f}};
+    std::mt19937 plan(genStreamSeed(dseed,0x80000000u));
+    std::uniform_int_distribution<int> wd(4,8);
+    struct Lot { int x,z,w,d; };
+    std::vector<Lot> lots;
+    int lo=CITY_ORIGIN, hi=CITY_ORIGIN+CITY_DISTRICT;
+    for(int sx=0;sx<4;sx++) for(int sz=0;sz<4;sz++) {
+        int x0=(sx==0)?lo:(streetPositions[sx-1]+streetWidth/2+1);
+        int x1=(sx==3)?hi:(streetPositions[sx]-streetWidth/2-1);
+        int z0=(sz==0)?lo:(streetPositions[sz-1]+streetWidth/2+1);
+        int z1=(sz==3)?hi:(streetPositions[sz]-streetWidth/2-1);
+        if(x1-x0<6||z1-z0<6) continue;
+        int bw=std::min(wd(plan)+2,x1-x0-2);
+        int bd=std::min(wd(plan)+2,z1-z0-2);
+        lots.push_back({ox+x0+1,oz+z0+1,bw,bd});
+        if(x1-x0>14) { int bw2=std::min(wd(plan)+2,x1-x0-bw-4); if(bw2>=4) lots.push_back({ox+x0+1+bw+2,oz+z0+1,bw2,bd}); }
+    }
+    for(const Lot& lot:lots) {
+        add(lot.x,lot.z,lot.x+lot.w-1,lot.z+lot.d-1,[=](std::mt19937& g, std::vector<Block>& out) {
+            std::uniform_int_distribution<int> hd(8,25),ci(0,5),wi(0,4),ant(0,3);
+            int h=hd(g); Vec3 wall=walls[ci(g)], win=wins[wi(g)]; bool antenna=ant(g)==0;
+            generateBuilding(out,g,lot.x,lot.z,lot.w,lot.d,h,wall,win,antenna);
+        });
+    }
+    add(ox+12,oz+12,ox+21,oz+21,[=](std::mt19937& g, std::vector<Block>& out) {
+        generateBuilding(out,g,ox+12,oz+12,10,10,35,{0.30f,0.32f,0.35f},{0.5f,0.6f,0.9f},true);
+    });
+}
+
+// A square of districts x districts City 17 layouts, streets running on from
+// one into the next. 1 is City 17 itself.
+static void generateCity(uint32_t seed, int districts) {
+    worldBlocks.clear();
+    std::vector<GenTask> tasks;
+    for(int dx=0;dx<districts;dx++) for(int dz=0;dz<districts;dz++) planDistrict(seed,dx,dz,tasks);
+    runGenTasks(tasks);
+    playerPos={8.0f,3.0f,8.0f};
+}
+
+static void generateCity17(uint32_t seed=42) { generateCity(seed,1); }
+
+// City 17 from `seed` (districts x districts of it), its grid built and the
+// shared rng seeded to match, so breaks that follow are reproducible. The
+// tests, the microbenchmarks and BENCH all start from this world.
+static void buildCity17Grid(uint32_t seed, int districts=1) {
+    rng.seed(seed);
+    generateCity(seed,districts);
+    rebuildGrid();
+}
+
+static int floorDiv(int a, int b) { return a>=0?a/b:-((-a+b-1)/b); }
+
+// Every block of the unbounded city that falls in chunk column (cx, cz), in
+// the order generateCity would produce them. Safe to call from any thread.
+static void generateColumn(uint32_t seed, int cx, int cz, std::vector<Block>& out) {
+    int x0=cx*CHUNK_SIZE, z0=cz*CHUNK_SIZE, x1=x0+CHUNK_SIZE-1, z1=z0+CHUNK_SIZE-1;
+    std::vector<GenTask> tasks;
+    std::vector<Block> piece;
+    for(int dx=floorDiv(x0-CITY_ORIGIN,CITY_DISTRICT);dx<=floorDiv(x1-CITY_ORIGIN,CITY_DISTRICT);dx++)
+    for(int dz=floorDiv(z0-CITY_ORIGIN,CITY_DISTRICT);dz<=floorDiv(z1-CITY_ORIGIN,CITY_DISTRICT);dz++) {
+        tasks.clear();
+        planDistrict(seed,dx,dz,tasks);
+        for(const GenTask& t:tasks) {
+            if(t.x1<x0||t.x0>x1||t.z1<z0||t.z0>z1) continue;
+            piece.clear();
+            std::mt19937 g(t.seed); t.run(g,piece);
+            for(const Block& b:piece) {
+                int bx,by,bz; blockCell(b,bx,by,bz);
+                if(bx>=x0&&bx<=x1&&bz>=z0&&bz<=z1) out.push_back(b);
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,501 @@
+#pragma once
+
+// Binary world snapshot. The file is mapped read-only and decoded one chunk
+// at a time as the player comes near, so startup only touches the header and
+// the chunk table and the OS pages the rest in on demand.
+//
+//   SnapshotHeader
+//   palette      SnapshotPaletteEntry[paletteCount]   every distinct colour+type
+//   chunk table  SnapshotChunk[chunkCount]            sorted by chunk key
+//   chunk data   per chunk: uint16 local palette (indices into the file
+//                palette), padded to 8 bytes, then 4096 cells of `bits` bits
+//                each packed into uint64 words; 0 is air, v is local[v - 1]
+//   debris       optional, see writeSnapshotFragments()
+//
+// Every section starts 8-byte aligned. Fields are little-endian, as on every
+// machine this runs on. A reader must reject any version it does not know.
+static const char WORLD_SNAPSHOT_MAGIC[8] = {'C', '1', '7', 'W', 'O', 'R', 'L', 'D'};
+static const uint32_t WORLD_SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+    uint64_t fileBytes;
+    uint64_t paletteOffset;
+    uint64_t chunkTableOffset;
+    uint64_t fragmentOffset;    // 0 when the snapshot carries no debris
+    uint32_t paletteCount;
+    uint32_t chunkCount;
+    float playerPos[3];
+    float camYaw, camPitch;
+    uint32_t pad;
+};
+
+struct SnapshotPaletteEntry {
+    float r, g, b;
+    int32_t type;
+};
+
+struct SnapshotChunk {
+    int32_t cx, cy, cz;
+    uint16_t blockCount;
+    uint16_t paletteSize;
+    uint8_t bits;
+    uint8_t pad[7];
+    uint64_t dataOffset;
+    uint64_t dataBytes;
+};
+
+struct SnapshotMeshHeader {
+    uint32_t vertCount, indCount;
+};
+
+struct SnapshotFragment {
+    float pos[3], vel[3], rot[3], spin[3], scale[3], tint[3];
+    float life, maxLife, radius;
+    int32_t mesh;
+    uint8_t eternal;
+    uint8_t pad[7];
+};
+
+static_assert(sizeof(SnapshotHeader) == 80, "snapshot header layout");
+static_assert(sizeof(SnapshotPaletteEntry) == 16, "snapshot palette layout");
+static_assert(sizeof(SnapshotChunk) == 40, "snapshot chunk layout");
+static_assert(sizeof(SnapshotFragment) == 96, "snapshot fragment layout");
+static_assert(sizeof(Vertex) == 36, "snapshot vertex layout");
+
+// A read-only file mapping. The handles belong to the OS and only
+// PLATFORM.cpp, which defines the calls below, looks inside them.
+struct MappedFile {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    void* file = nullptr;
+    void* mapping = nullptr;
+};
+
+static bool mapFileReadOnly(const char* path, MappedFile& m);
+static void unmapFile(MappedFile& m);
+static bool replaceFile(const char* from, const char* to);
+static void makeDirectory(const char* path);
+
+// A snapshot image in memory, owned by whoever mapped or read it.
+struct SnapshotView {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    const SnapshotHeader* header = nullptr;
+    const SnapshotPaletteEntry* palette = nullptr;
+    const SnapshotChunk* chunks = nullptr;
+};
+
+// A mapped snapshot and which of its chunks are already in the grid.
+struct WorldSnapshot : SnapshotView {
+    MappedFile file;
+    std::vector<uint8_t> resident;
+    uint32_t residentCount = 0;
+    uint32_t badChunks = 0;
+    int pageCx = INT32_MIN, pageCy = 0, pageCz = 0;
+};
+
+static WorldSnapshot worldSnapshot;
+static float snapshotPageRadius = 112.0f;
+
+static size_t alignSnapshot(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+static bool mapSnapshotFile(const char* path, WorldSnapshot& s) {
+    if (!mapFileReadOnly(path, s.file)) return false;
+    s.data = s.file.data;
+    s.size = s.file.size;
+    return true;
+}
+
+static void unmapSnapshotFile(WorldSnapshot& s) {
+    unmapFile(s.file);
+    s.data = nullptr;
+    s.size = 0;
+}
+
+static void closeWorldSnapshot() {
+    unmapSnapshotFile(worldSnapshot);
+    worldSnapshot = WorldSnapshot();
+}
+
+static bool snapshotRangeValid(const SnapshotView& s, uint64_t offset, uint64_t bytes) {
+    return offset % 8 == 0 && offset <= s.size && bytes <= s.size - offset;
+}
+
+// Checks the header and the palette and chunk table bounds of s.data, and
+// points the view at them. Chunks are checked as they are decoded.
+static bool openSnapshotView(SnapshotView& s) {
+    const SnapshotHeader* h = (const SnapshotHeader*)s.data;
+    bool ok = s.size >= sizeof(SnapshotHeader)
+        && !memcmp(h->magic, WORLD_SNAPSHOT_MAGIC, sizeof(h->magic))
+        && h->version == WORLD_SNAPSHOT_VERSION
+        && h->headerBytes == sizeof(SnapshotHeader)
+        && h->fileBytes == s.size
+        && snapshotRangeValid(s, h->paletteOffset, (uint64_t)h->paletteCount * sizeof(SnapshotPaletteEntry))
+        && snapshotRangeValid(s, h->chunkTableOffset, (uint64_t)h->chunkCount * sizeof(SnapshotChunk));
+    if (!ok) return false;
+    s.header = h;
+    s.palette = (const SnapshotPaletteEntry*)(s.data + h->paletteOffset);
+    s.chunks = (const SnapshotChunk*)(s.data + h->chunkTableOffset);
+    return true;
+}
+
+static uint32_t readPackedCell(const uint64_t* words, uint32_t bitPos, int bits) {
+    uint32_t w = bitPos >> 6, o = bitPos & 63;
+    uint64_t v = words[w] >> o;
+    if (o + bits > 64) v |= words[w + 1] << (64 - o);
+    return (uint32_t)(v & ((1ull << bits) - 1));
+}
+
+// Calls emit(lx, ly, lz, entry) for every solid cell of chunk c, in cell
+// order. Returns false, possibly part way through, if the chunk fails its
+// checks. Touches nothing but the view, so it is safe on any thread.
+template <typename Emit>
+static bool decodeSnapshotChunk(const SnapshotView& s, const SnapshotChunk& c, Emit emit) {
+    size_t paletteBytes = alignSnapshot((size_t)c.paletteSize * sizeof(uint16_t));
+    size_t cellBytes = (size_t)CHUNK_VOLUME * c.bits / 8;
+    if (c.bits < 1 || c.bits > 16 || c.paletteSize == 0 || c.paletteSize >= (1u << c.bits)
+        || c.dataBytes < paletteBytes + cellBytes || !snapshotRangeValid(s, c.dataOffset, c.dataBytes))
+        return false;
+    const uint16_t* local = (const uint16_t*)(s.data + c.dataOffset);
+    const uint64_t* words = (const uint64_t*)(s.data + c.dataOffset + paletteBytes);
+    for (int k = 0; k < c.paletteSize; k++) {
+        if (local[k] >= s.header->paletteCount) return false;
+    }
+    for (uint32_t cell = 0; cell < (uint32_t)CHUNK_VOLUME; cell++) {
+        uint32_t v = readPackedCell(words, cell * c.bits, c.bits);
+        if (!v) continue;
+        if (v > c.paletteSize) return false;
+        emit(cell & CHUNK_MASK, cell >> (CHUNK_SHIFT * 2), (cell >> CHUNK_SHIFT) & CHUNK_MASK, s.palette[local[v - 1]]);
+    }
+    return true;
+}
+
+// Decodes chunk i into worldBlocks and the grid. A chunk that fails its checks
+// is counted and left empty, or as far as it got, rather than trusted.
+static void pageInSnapshotChunk(uint32_t i) {
+    WorldSnapshot& s = worldSnapshot;
+    if (s.resident[i]) return;
+    s.resident[i] = 1;
+    s.residentCount++;
+    const SnapshotChunk& c = s.chunks[i];
+    initGrid();
+    ChunkSection* sec = nullptr;
+    int baseX = c.cx * CHUNK_SIZE, baseY = c.cy * CHUNK_SIZE, baseZ = c.cz * CHUNK_SIZE;
+    bool ok = decodeSnapshotChunk(s, c, [&](int lx, int ly, int lz, const SnapshotPaletteEntry& e) {
+        if (!sec) sec = blockGrid->chunkAt(c.cx, c.cy, c.cz);
+        addBlock({(float)(baseX + lx), (float)(baseY + ly), (float)(baseZ + lz)}, {e.r, e.g, e.b}, e.type);
+        sec->set(lx, ly, lz, (int)worldBlocks.size() - 1);
+    });
+    if (!ok) s.badChunks++;
+    // Neighbours meshed before this chunk arrived drew their faces towards it.
+    static const int dirs[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+    for (auto& d : dirs) {
+        ChunkSection* n = blockGrid->findChunk(c.cx + d[0], c.cy + d[1], c.cz + d[2]);
+        if (n) n->dirty = true;
+    }
+}
+
+// Decodes every chunk whose centre lies within `radius` of p. Returns how many
+// were paged in.
+static int pageInWorldNear(Vec3 p, float radius) {
+    WorldSnapshot& s = worldSnapshot;
+    if (!s.data || s.residentCount == s.header->chunkCount) return 0;
+    float reach = radius + CHUNK_RADIUS;
+    int paged = 0;
+    for (uint32_t i = 0; i < s.header->chunkCount; i++) {
+        if (s.resident[i]) continue;
+        const SnapshotChunk& c = s.chunks[i];
+        float half = CHUNK_SIZE * 0.5f - 0.5f;
+        Vec3 center = {(float)(c.cx * CHUNK_SIZE) + half, (float)(c.cy * CHUNK_SIZE) + half, (float)(c.cz * CHUNK_SIZE) + half};
+        if ((center - p).lengthSq() > reach * reach) continue;
+        pageInSnapshotChunk(i);
+        paged++;
+    }
+    return paged;
+}
+
+// Once per tick: pages in around the player whenever it enters a new chunk.
+static void updateWorldPaging(Vec3 p) {
+    WorldSnapshot& s = worldSnapshot;
+    if (!s.data) return;
+    int cx = (int)floorf(p.x + 0.5f) >> CHUNK_SHIFT;
+    int cy = (int)floorf(p.y + 0.5f) >> CHUNK_SHIFT;
+    int cz = (int)floorf(p.z + 0.5f) >> CHUNK_SHIFT;
+    if (cx == s.pageCx && cy == s.pageCy && cz == s.pageCz) return;
+    s.pageCx = cx; s.pageCy = cy; s.pageCz = cz;
+    pageInWorldNear(p, snapshotPageRadius);
+}
+
+static void pageInWholeSnapshot() {
+    WorldSnapshot& s = worldSnapshot;
+    if (!s.data) return;
+    for (uint32_t i = 0; i < s.header->chunkCount; i++) pageInSnapshotChunk(i);
+}
+
+// Debris: a mesh table, then the fragments that use it.
+//   uint32 meshCount, uint32 fragmentCount
+//   meshCount x (SnapshotMeshHeader, Vertex[vertCount], uint32[indCount], pad to 8)
+//   SnapshotFragment[fragmentCount]
+// Sleeping fragments are saved with the life they have left and come back
+// awake; they settle and fall asleep again within a second.
+static void loadSnapshotFragments() {
+    WorldSnapshot& s = worldSnapshot;
+    uint64_t at = s.header->fragmentOffset;
+    if (!at || !snapshotRangeValid(s, at, 8)) return;
+    const uint32_t* counts = (const uint32_t*)(s.data + at);
+    uint32_t meshCount = counts[0], fragmentCount = counts[1];
+    at += 8;
+    if (!snapshotRangeValid(s, at, (uint64_t)meshCount * sizeof(SnapshotMeshHeader))) return;
+    std::vector<int> meshIds;
+    meshIds.reserve(meshCount);
+    for (uint32_t m = 0; m < meshCount; m++) {
+        if (!snapshotRangeValid(s, at, sizeof(SnapshotMeshHeader))) break;
+        const SnapshotMeshHeader* mh = (const SnapshotMeshHeader*)(s.data + at);
+        uint64_t bytes = sizeof(SnapshotMeshHeader) + (uint64_t)mh->vertCount * sizeof(Vertex) + (uint64_t)mh->indCount * sizeof(uint32_t);
+        if (!snapshotRangeValid(s, at, bytes)) break;
+        const Vertex* v = (const Vertex*)(s.data + at + sizeof(SnapshotMeshHeader));
+        const uint32_t* ind = (const uint32_t*)(v + mh->vertCount);
+        bool ok = true;
+        for (uint32_t k = 0; k < mh->indCount; k++) if (ind[k] >= mh->vertCount) { ok = false; break; }
+        if (!ok) break;
+        meshIds.push_back(createMesh(std::vector<Vertex>(v, v + mh->vertCount), std::vector<uint32_t>(ind, ind + mh->indCount)));
+        at += alignSnapshot(bytes);
+    }
+    if (meshIds.size() == meshCount && snapshotRangeValid(s, at, (uint64_t)fragmentCount * sizeof(SnapshotFragment))) {
+        const SnapshotFragment* sf = (const SnapshotFragment*)(s.data + at);
+        for (uint32_t k = 0; k < fragmentCount; k++) {
+            const SnapshotFragment& r = sf[k];
+            if (r.mesh < 0 || r.mesh >= (int32_t)meshCount) continue;
+            Fragment fr;
+            fr.position = {r.pos[0], r.pos[1], r.pos[2]};
+            fr.velocity = {r.vel[0], r.vel[1], r.vel[2]};
+            fr.rotation = {r.rot[0], r.rot[1], r.rot[2]};
+            fr.rotSpeed = {r.spin[0], r.spin[1], r.spin[2]};
+            fr.scale = {r.scale[0], r.scale[1], r.scale[2]};
+            fr.tint = {r.tint[0], r.tint[1], r.tint[2]};
+            fr.color = fr.tint;
+            fr.mesh = meshIds[r.mesh];
+            fr.lifetime = r.life;
+            fr.maxLifetime = r.maxLife;
+            fr.eternal = r.eternal != 0;
+            fr.active = true;
+            retainMesh(fr.mesh);
+            spawnFragment(fr, r.radius);
+        }
+    }
+    // createMesh's own reference goes; the fragments hold theirs.
+    for (int id : meshIds) releaseMesh(id);
+}
+
+// Replaces the world with the snapshot at `path`: maps it, restores the
+// player, pages in everything near the player and, when asked, the debris.
+// Call it before anything has been meshed. Returns false if the file is
+// missing or not a snapshot this build understands; the world is then left
+// untouched.
+static bool loadWorldSnapshot(const char* path, bool withFragments = true) {
+    closeWorldSnapshot();
+    WorldSnapshot& s = worldSnapshot;
+    if (!mapSnapshotFile(path, s)) return false;
+    if (!openSnapshotView(s)) { closeWorldSnapshot(); return false; }
+    const SnapshotHeader* h = s.header;
+    s.resident.assign(h->chunkCount, 0);
+
+    worldBlocks.clear();
+    worldBlocks.reserve((size_t)h->chunkCount * 64);
+    initGrid();
+    blockGrid->clear();
+    playerPos = {h->playerPos[0], h->playerPos[1], h->playerPos[2]};
+    playerVel = {0, 0, 0};
+    camYaw = h->camYaw;
+    camPitch = h->camPitch;
+    updateWorldPaging(playerPos);
+    if (withFragments) loadSnapshotFragments();
+    return true;
+}
+
+struct SnapshotPaletteKey {
+    uint32_t rgb[3];
+    int32_t type;
+    bool operator<(const SnapshotPaletteKey& o) const { return memcmp(this, &o, sizeof(*this)) < 0; }
+};
+
+template <typename T>
+static void appendSnapshot(std::vector<uint8_t>& out, const T* items, size_t count) {
+    const uint8_t* p = (const uint8_t*)items;
+    out.insert(out.end(), p, p + count * sizeof(T));
+}
+
+static void padSnapshot(std::vector<uint8_t>& out) {
+    out.resize(alignSnapshot(out.size()), 0);
+}
+
+static void writeSnapshotFragments(std::vector<uint8_t>& out) {
+    std::vector<SnapshotFragment> rows;
+    std::unordered_map<int, int32_t> meshIndex;
+    std::vector<int> meshes;
+    auto addRows = [&](const FragmentStore& f, const std::vector<double>* deathTime) {
+        for (size_t i = 0; i < f.size(); i++) {
+            if (f.mesh[i] < 0) continue;
+            auto it = meshIndex.find(f.mesh[i]);
+            if (it == meshIndex.end()) {
+                it = meshIndex.emplace(f.mesh[i], (int32_t)meshes.size()).first;
+                meshes.push_back(f.mesh[i]);
+            }
+            SnapshotFragment r = {};
+            r.pos[0] = f.px[i]; r.pos[1] = f.py[i]; r.pos[2] = f.pz[i];
+            r.vel[0] = f.vx[i]; r.vel[1] = f.vy[i]; r.vel[2] = f.vz[i];
+            r.rot[0] = f.rx[i]; r.rot[1] = f.ry[i]; r.rot[2] = f.rz[i];
+            r.spin[0] = f.wx[i]; r.spin[1] = f.wy[i]; r.spin[2] = f.wz[i];
+            r.scale[0] = f.sx[i]; r.scale[1] = f.sy[i]; r.scale[2] = f.sz[i];
+            r.tint[0] = f.tr[i]; r.tint[1] = f.tg[i]; r.tint[2] = f.tb[i];
+            r.life = f.life[i];
+            r.maxLife = f.maxLife[i];
+            if (deathTime && !f.eternal[i]) r.life = f.maxLife[i] - (float)((*deathTime)[i] - physicsTime);
+            r.radius = f.radius[i];
+            r.mesh = it->second;
+            r.eternal = f.eternal[i];
+            rows.push_back(r);
+        }
+    };
+    addRows(fragments, nullptr);
+    for (auto& kv : sleepingFragments) addRows(kv.second.frags, &kv.second.deathTime);
+
+    uint32_t counts[2] = {(uint32_t)meshes.size(), (uint32_t)rows.size()};
+    appendSnapshot(out, counts, 2);
+    for (int id : meshes) {
+        const MeshData& m = meshLibrary[id];
+        SnapshotMeshHeader mh = {(uint32_t)m.verts.size(), (uint32_t)m.inds.size()};
+        appendSnapshot(out, &mh, 1);
+        appendSnapshot(out, m.verts.data(), m.verts.size());
+        appendSnapshot(out, m.inds.data(), m.inds.size());
+        padSnapshot(out);
+    }
+    appendSnapshot(out, rows.data(), rows.size());
+}
+
+// Encodes the grid sections in `keys` (sorted, non-empty), and the debris if
+// asked, as a complete snapshot image in `out`. Fails if a key names no
+// section or the sections use more distinct colours than the palette can index.
+static bool encodeSnapshot(const std::vector<uint64_t>& keys, bool withFragments, std::vector<uint8_t>& out) {
+    std::map<SnapshotPaletteKey, uint16_t> paletteIndex;
+    std::vector<SnapshotPaletteEntry> palette;
+    std::vector<SnapshotChunk> table(keys.size());
+    std::vector<uint8_t> chunkData;
+    std::vector<uint16_t> cellValue(CHUNK_VOLUME);
+    std::vector<uint16_t> local;
+    std::map<uint16_t, uint16_t> localIndex;
+    for (size_t k = 0; k < keys.size(); k++) {
+        auto sit = blockGrid->chunks.find(keys[k]);
+        if (sit == blockGrid->chunks.end()) return false;
+        const ChunkSection& sec = *sit->second;
+        local.clear();
+        localIndex.clear();
+        int blocks = 0;
+        for (int cell = 0; cell < CHUNK_VOLUME; cell++) {
+            uint16_t id = sec.cells[cell];
+            int idx = id ? sec.blocks[id - 1] : -1;
+            if (idx < 0) { cellValue[cell] = 0; continue; }
+            const Block& bl = worldBlocks[idx];
+            SnapshotPaletteKey key;
+            memcpy(&key.rgb[0], &bl.color.x, 4);
+            memcpy(&key.rgb[1], &bl.color.y, 4);
+            memcpy(&key.rgb[2], &bl.color.z, 4);
+            key.type = bl.type;
+            auto pit = paletteIndex.find(key);
+            if (pit == paletteIndex.end()) {
+                if (palette.size() >= 0xFFFF) return false;
+                pit = paletteIndex.emplace(key, (uint16_t)palette.size()).first;
+                palette.push_back({bl.color.x, bl.color.y, bl.color.z, bl.type});
+            }
+            auto lit = localIndex.find(pit->second);
+            if (lit == localIndex.end()) {
+                lit = localIndex.emplace(pit->second, (uint16_t)local.size()).first;
+                local.push_back(pit->second);
+            }
+            cellValue[cell] = lit->second + 1;
+            blocks++;
+        }
+        int bits = 1;
+        while ((1u << bits) <= local.size()) bits++;
+
+        SnapshotChunk& c = table[k];
+        memset(&c, 0, sizeof(c));
+        c.cx = sec.cx; c.cy = sec.cy; c.cz = sec.cz;
+        c.blockCount = (uint16_t)blocks;
+        c.paletteSize = (uint16_t)local.size();
+        c.bits = (uint8_t)bits;
+        c.dataOffset = chunkData.size();
+        appendSnapshot(chunkData, local.data(), local.size());
+        padSnapshot(chunkData);
+        std::vector<uint64_t> words((size_t)CHUNK_VOLUME * bits / 64, 0);
+        for (uint32_t cell = 0; cell < (uint32_t)CHUNK_VOLUME; cell++) {
+            uint64_t v = cellValue[cell];
+            uint32_t bitPos = cell * bits, w = bitPos >> 6, o = bitPos & 63;
+            words[w] |= v << o;
+            if (o + bits > 64) words[w + 1] |= v >> (64 - o);
+        }
+        appendSnapshot(chunkData, words.data(), words.size());
+        c.dataBytes = chunkData.size() - c.dataOffset;
+    }
+
+    out.assign(sizeof(SnapshotHeader), 0);
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, WORLD_SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = WORLD_SNAPSHOT_VERSION;
+    h.headerBytes = sizeof(SnapshotHeader);
+    h.paletteOffset = out.size();
+    h.paletteCount = (uint32_t)palette.size();
+    appendSnapshot(out, palette.data(), palette.size());
+    padSnapshot(out);
+    h.chunkTableOffset = out.size();
+    h.chunkCount = (uint32_t)table.size();
+    uint64_t dataBase = out.size() + table.size() * sizeof(SnapshotChunk);
+    for (SnapshotChunk& c : table) c.dataOffset += dataBase;
+    appendSnapshot(out, table.data(), table.size());
+    out.insert(out.end(), chunkData.begin(), chunkData.end());
+    padSnapshot(out);
+    if (withFragments) {
+        h.fragmentOffset = out.size();
+        writeSnapshotFragments(out);
+        padSnapshot(out);
+    }
+    h.playerPos[0] = playerPos.x; h.playerPos[1] = playerPos.y; h.playerPos[2] = playerPos.z;
+    h.camYaw = camYaw;
+    h.camPitch = camPitch;
+    h.fileBytes = out.size();
+    memcpy(out.data(), &h, sizeof(h));
+    return true;
+}
+
+// Writes `bytes` to `path` through a temporary file, so a crash never leaves
+// half a snapshot behind.
+static bool writeSnapshotFile(const char* path, const std::vector<uint8_t>& bytes) {
+    std::string tmp = std::string(path) + ".tmp";
+    FILE* f = fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool written = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    written = fclose(f) == 0 && written;
+    if (!written) { remove(tmp.c_str()); return false; }
+    return replaceFile(tmp.c_str(), path);
+}
+
+// Writes the current world (broken blocks stay broken) to `path`. A mapped
+// snapshot is paged in completely and closed first, since it may be the file
+// being replaced.
+static bool saveWorldSnapshot(const char* path, bool withFragments = true) {
+    pageInWholeSnapshot();
+    closeWorldSnapshot();
+    initGrid();
+
+    std::vector<uint64_t> keys;
+    for (auto& kv : blockGrid->chunks) if (kv.second->count > 0) keys.push_back(kv.first);
+    std::sort(keys.begin(), keys.end());
+    std::vector<uint8_t> out;
+    return encodeSnapshot(keys, withFragments, out) && writeSnapshotFile(path, out);
+}
\ No newline at end of file
@@ -0,0 +1,275 @@
+#pragma once
+
+// Streaming open world. Instead of building the whole map up front, the world
+// is kept as the chunk columns (one CHUNK_SIZE x CHUNK_SIZE footprint, every
+// height) near the player:
+//
+//  - a column whose centre comes within streamLoadRadius is built on a worker,
+//    from its save file if the player changed it earlier, else straight from
+//    the generator, and joins the grid STREAM_PUBLISH_DELAY ticks later;
+//  - a column further than streamEvictRadius is dropped, after writing it to
+//    its save file if a block in it was broken. The gap between the two radii
+//    keeps a player walking along a border from loading and dropping the same
+//    columns over and over.
+//
+// Meshing, collision and raycasts only ever look at the grid, so they only see
+// resident columns. Dropped columns give back their grid sections, chunk
+// meshes (and GPU ranges), sleeping debris and worldBlocks slots, which new
+// columns reuse, so memory follows the radius, not the distance travelled.
+// The one thing that grows is the set of edited columns, a key each.
+//
+// Loads are submitted in a fixed order and published on a fixed tick, waiting
+// if the job is late, so the same walk gives the same world on any thread
+// count.
+
+static float streamLoadRadius = 96.0f;
+static float streamEvictRadius = 128.0f;
+static int streamLoadsPerTick = 8;          // new columns submitted per tick at most
+static const int STREAM_PUBLISH_DELAY = 2;
+static const char* streamDir = "stream_cache";
+
+struct StreamColumn {
+    bool resident = false;                  // false while its load job is in flight
+    bool pinned = false;                    // edited but could not be saved; never dropped
+    std::vector<uint64_t> sections;         // grid keys of the sections it filled
+};
+
+struct ColumnJob {
+    int cx, cz;
+    bool fromFile;
+    uint64_t dueTick;
+    JobCounter done;
+    std::vector<Block> blocks;
+};
+
+struct WorldStream {
+    bool active = false;
+    uint32_t seed = 0;
+    uint64_t tick = 0;
+    std::unordered_map<uint64_t, StreamColumn> columns;
+    std::unordered_set<uint64_t> saved;     // columns with a save file from this session
+    std::deque<std::unique_ptr<ColumnJob>> jobs;
+    std::vector<int> freeBlocks;            // worldBlocks slots of dropped columns
+    size_t residentColumns = 0;
+    uint64_t loads = 0, evictions = 0, saves = 0, badFiles = 0;
+};
+
+static WorldStream worldStream;
+
+static uint64_t columnKey(int cx, int cz) {
+    return chunkKey(cx, 0, cz);
+}
+
+static float columnDistSq(int cx, int cz, Vec3 p) {
+    float half = CHUNK_SIZE * 0.5f - 0.5f;
+    float dx = (float)(cx * CHUNK_SIZE) + half - p.x, dz = (float)(cz * CHUNK_SIZE) + half - p.z;
+    return dx * dx + dz * dz;
+}
+
+static std::string columnPath(int cx, int cz) {
+    char name[64];
+    snprintf(name, sizeof(name), "/%d_%d.c17", cx, cz);
+    return std::string(streamDir) + name;
+}
+
+// Reads back a column written by saveColumn. Runs on a worker.
+static bool readColumnFile(int cx, int cz, std::vector<Block>& out) {
+    FILE* f = fopen(columnPath(cx, cz).c_str(), "rb");
+    if (!f) return false;
+    std::vector<uint8_t> bytes;
+    uint8_t buf[16384];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) bytes.insert(bytes.end(), buf, buf + n);
+    fclose(f);
+    SnapshotView s;
+    s.data = bytes.data();
+    s.size = bytes.size();
+    if (!openSnapshotView(s)) return false;
+    for (uint32_t i = 0; i < s.header->chunkCount; i++) {
+        const SnapshotChunk& c = s.chunks[i];
+        if (c.cx != cx || c.cz != cz) return false;
+        int baseX = c.cx * CHUNK_SIZE, baseY = c.cy * CHUNK_SIZE, baseZ = c.cz * CHUNK_SIZE;
+        bool ok = decodeSnapshotChunk(s, c, [&](int lx, int ly, int lz, const SnapshotPaletteEntry& e) {
+            addBlock(out, {(float)(baseX + lx), (float)(baseY + ly), (float)(baseZ + lz)}, {e.r, e.g, e.b}, e.type);
+        });
+        if (!ok) return false;
+    }
+    return true;
+}
+
+static void runColumnJob(ColumnJob& job, uint32_t seed) {
+    if (job.fromFile) {
+        if (readColumnFile(job.cx, job.cz, job.blocks)) return;
+        job.blocks.clear();
+        job.fromFile = false;
+    }
+    generateColumn(seed, job.cx, job.cz, job.blocks);
+}
+
+static void submitColumn(int cx, int cz) {
+    WorldStream& ws = worldStream;
+    uint64_t key = columnKey(cx, cz);
+    ws.columns[key];
+    std::unique_ptr<ColumnJob> job(new ColumnJob());
+    job->cx = cx;
+    job->cz = cz;
+    job->fromFile = ws.saved.count(key) != 0;
+    job->dueTick = ws.tick + STREAM_PUBLISH_DELAY;
+    ColumnJob* j = job.get();
+    uint32_t seed = ws.seed;
+    submitJob([j, seed] { runColumnJob(*j, seed); }, j->done);
+    ws.jobs.push_back(std::move(job));
+}
+
+// Main thread: moves a finished column into worldBlocks and the grid.
+static void publishColumn(ColumnJob& job) {
+    WorldStream& ws = worldStream;
+    waitJobs(job.done);
+    if (ws.saved.count(columnKey(job.cx, job.cz)) && !job.fromFile) ws.badFiles++;
+    StreamColumn& col = ws.columns[columnKey(job.cx, job.cz)];
+    initGrid();
+    for (const Block& b : job.blocks) {
+        int bx, by, bz;
+        blockCell(b, bx, by, bz);
+        // The generator can place two blocks in one cell; the later one wins,
+        // as in rebuildGrid, and keeps the first one's slot.
+        int idx = blockGrid->get(bx, by, bz);
+        if (idx >= 0) { worldBlocks[idx] = b; continue; }
+        if (!ws.freeBlocks.empty()) {
+            idx = ws.freeBlocks.back();
+            ws.freeBlocks.pop_back();
+            worldBlocks[idx] = b;
+        } else {
+            idx = (int)worldBlocks.size();
+            worldBlocks.push_back(b);
+        }
+        blockGrid->set(bx, by, bz, idx);
+        uint64_t sec = chunkKey(job.cx, by >> CHUNK_SHIFT, job.cz);
+        if (std::find(col.sections.begin(), col.sections.end(), sec) == col.sections.end()) col.sections.push_back(sec);
+    }
+    col.resident = true;
+    ws.residentColumns++;
+    ws.loads++;
+}
+
+static bool saveColumn(int cx, int cz, const StreamColumn& col) {
+    std::vector<uint64_t> keys;
+    for (uint64_t k : col.sections) {
+        auto it = blockGrid->chunks.find(k);
+        if (it != blockGrid->chunks.end() && it->second->count > 0) keys.push_back(k);
+    }
+    std::sort(keys.begin(), keys.end());
+    std::vector<uint8_t> bytes;
+    return encodeSnapshot(keys, false, bytes) && writeSnapshotFile(columnPath(cx, cz).c_str(), bytes);
+}
+
+// Drops a resident column. One with broken blocks is saved first; if that
+// fails it is pinned rather than losing the player's changes.
+static void evictColumn(int cx, int cz) {
+    WorldStream& ws = worldStream;
+    uint64_t key = columnKey(cx, cz);
+    StreamColumn& col = ws.columns[key];
+    bool edited = false;
+    for (uint64_t k : col.sections) {
+        auto it = blockGrid->chunks.find(k);
+        if (it != blockGrid->chunks.end() && it->second->edited) edited = true;
+    }
+    if (edited) {
+        if (!saveColumn(cx, cz, col)) { col.pinned = true; return; }
+        ws.saved.insert(key);
+        ws.saves++;
+    }
+    for (uint64_t k : col.sections) {
+        auto it = blockGrid->chunks.find(k);
+        if (it != blockGrid->chunks.end()) {
+            for (int idx : it->second->blocks) {
+                if (idx < 0) continue;
+                worldBlocks[idx].active = false;
+                ws.freeBlocks.push_back(idx);
+            }
+        }
+        blockGrid->dropChunk(k);
+        dropChunkMesh(k);
+    }
+    dropSleepersInColumn(cx, cz);
+    ws.columns.erase(key);
+    ws.residentColumns--;
+    ws.evictions++;
+}
+
+// Submits the missing columns within the load radius of p, nearest first.
+static void requestColumnsNear(Vec3 p, int limit) {
+    WorldStream& ws = worldStream;
+    int r = (int)ceilf(streamLoadRadius / CHUNK_SIZE) + 1;
+    int pcx = (int)floorf(p.x + 0.5f) >> CHUNK_SHIFT, pcz = (int)floorf(p.z + 0.5f) >> CHUNK_SHIFT;
+    float reach = streamLoadRadius * streamLoadRadius;
+    struct Want { float d; int cx, cz; };
+    std::vector<Want> want;
+    for (int cx = pcx - r; cx <= pcx + r; cx++)
+        for (int cz = pcz - r; cz <= pcz + r; cz++) {
+            float d = columnDistSq(cx, cz, p);
+            if (d > reach || ws.columns.count(columnKey(cx, cz))) continue;
+            want.push_back({d, cx, cz});
+        }
+    std::sort(want.begin(), want.end(), [](const Want& a, const Want& b) {
+        return a.d != b.d ? a.d < b.d : (a.cx != b.cx ? a.cx < b.cx : a.cz < b.cz);
+    });
+    for (size_t i = 0; i < want.size() && (int)i < limit; i++) submitColumn(want[i].cx, want[i].cz);
+}
+
+// Once per tick: drops far columns, publishes loads that are due and asks for
+// new ones around p.
+static void updateStreaming(Vec3 p) {
+    WorldStream& ws = worldStream;
+    if (!ws.active) return;
+    ws.tick++;
+
+    std::vector<uint64_t> distant;
+    float evict = streamEvictRadius * streamEvictRadius;
+    for (auto& kv : ws.columns) {
+        if (!kv.second.resident || kv.second.pinned) continue;
+        int cx, cy, cz;
+        chunkKeyCoords(kv.first, cx, cy, cz);
+        if (columnDistSq(cx, cz, p) > evict) distant.push_back(kv.first);
+    }
+    std::sort(distant.begin(), distant.end());
+    for (uint64_t key : distant) {
+        int cx, cy, cz;
+        chunkKeyCoords(key, cx, cy, cz);
+        evictColumn(cx, cz);
+    }
+
+    while (!ws.jobs.empty() && ws.jobs.front()->dueTick <= ws.tick) {
+        publishColumn(*ws.jobs.front());
+        ws.jobs.pop_front();
+    }
+    requestColumnsNear(p, streamLoadsPerTick);
+}
+
+// Publishes every load in flight now, e.g. before saving or shutting down.
+static void flushStreaming() {
+    WorldStream& ws = worldStream;
+    while (!ws.jobs.empty()) {
+        publishColumn(*ws.jobs.front());
+        ws.jobs.pop_front();
+    }
+}
+
+// Replaces the world with a streamed city from `seed`, starting at the same
+// spot generateCity would, with the columns around it already in place.
+static void beginStreamingWorld(uint32_t seed) {
+    flushStreaming();
+    closeWorldSnapshot();
+    WorldStream& ws = worldStream;
+    ws = WorldStream();
+    ws.active = true;
+    ws.seed = seed;
+    makeDirectory(streamDir);
+    worldBlocks.clear();
+    initGrid();
+    blockGrid->clear();
+    clearChunkMeshes();
+    playerPos = {8.0f, 3.0f, 8.0f};
+    requestColumnsNear(playerPos, INT_MAX);
+    flushStreaming();
+}
\ No newline at end of file